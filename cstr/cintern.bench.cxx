@@ -0,0 +1,179 @@
+#include <benchmark/benchmark.h>
+#include <stdexcept>
+
+#include "cintern.h"
+
+#include <random>
+#include <string>
+#include <vector>
+
+// Symbol names compared pairwise, as a matching engine would: with cstr_eq
+// on separate copies of the names, or interned once and compared by handle.
+
+static std::vector<std::string> MakeSymbols(std::size_t n)
+{
+    std::vector<std::string> symbols;
+    for (std::size_t i = 0; i < n; ++i) {
+        // a shared prefix so that unequal names of equal length still memcmp
+        // past the first bytes; a third too long to be inline
+        symbols.push_back("XNAS.EQUITY." + std::to_string(100000 + i) +
+                          (i % 3 == 0 ? ".ORDINARY.SHARES" : ""));
+    }
+    return symbols;
+}
+
+static std::vector<std::size_t> MakePairs(std::size_t nsymbols, std::size_t npairs)
+{
+    std::mt19937_64 gen(42);
+    std::vector<std::size_t> idx;
+    for (std::size_t i = 0; i < 2 * npairs; ++i) {
+        // half of the pairs equal
+        idx.push_back(i % 4 == 1 ? idx.back() : gen() % nsymbols);
+    }
+    return idx;
+}
+
+static constexpr std::size_t NPairs = 4096;
+
+static void BM_CompareCStrEq(benchmark::State& state)
+{
+    const auto symbols = MakeSymbols(static_cast<std::size_t>(state.range(0)));
+    const auto pairs   = MakePairs(symbols.size(), NPairs);
+    // two copies, so equal names are never the same object
+    std::vector<cstr> a, b;
+    for (auto&& s : symbols) {
+        a.push_back(cstr_make(s.data(), s.size()));
+        b.push_back(cstr_make(s.data(), s.size()));
+    }
+    int64_t count = 0;
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < pairs.size(); i += 2) {
+            count += cstr_eq(&a[pairs[i]], &b[pairs[i + 1]]);
+        }
+    }
+
+    if (count == 0) {
+        throw std::runtime_error("invalid!");
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(NPairs));
+    for (auto& s : a) cstr_destroy(&s);
+    for (auto& s : b) cstr_destroy(&s);
+}
+BENCHMARK(BM_CompareCStrEq)->Arg(64)->Arg(4096)->Arg(256<<10);
+
+static void BM_CompareInterned(benchmark::State& state)
+{
+    const auto symbols = MakeSymbols(static_cast<std::size_t>(state.range(0)));
+    const auto pairs   = MakePairs(symbols.size(), NPairs);
+    cintern_pool* pool = cintern_pool_new();
+    std::vector<cintern> handles;
+    for (auto&& s : symbols) {
+        handles.push_back(cintern_intern(pool, cstrview_init(s.data(), s.size())));
+    }
+    int64_t count = 0;
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < pairs.size(); i += 2) {
+            count += cintern_eq(handles[pairs[i]], handles[pairs[i + 1]]);
+        }
+    }
+
+    if (count == 0) {
+        throw std::runtime_error("invalid!");
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(NPairs));
+    cintern_pool_del(pool);
+}
+BENCHMARK(BM_CompareInterned)->Arg(64)->Arg(4096)->Arg(256<<10);
+
+// the names arrive as text and are interned on the way in, then each is
+// compared against `ncompares` others; interning pays off once the same
+// name is compared a few times
+static void BM_InternThenCompare(benchmark::State& state)
+{
+    const auto ncompares = static_cast<std::size_t>(state.range(0));
+    const auto symbols = MakeSymbols(4096);
+    const auto pairs   = MakePairs(symbols.size(), NPairs);
+    cintern_pool* pool = cintern_pool_new();
+    std::vector<cintern> handles;
+    for (auto&& s : symbols) {
+        handles.push_back(cintern_intern(pool, cstrview_init(s.data(), s.size())));
+    }
+    int64_t count = 0;
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < pairs.size(); i += 2) {
+            const std::string& s = symbols[pairs[i]];
+            cintern h = cintern_intern(pool, cstrview_init(s.data(), s.size()));
+            for (std::size_t k = 0; k < ncompares; ++k) {
+                count += cintern_eq(h, handles[pairs[(i + 2 * k + 1) % pairs.size()]]);
+            }
+        }
+    }
+
+    if (count == 0) {
+        throw std::runtime_error("invalid!");
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(NPairs / 2 * ncompares));
+    cintern_pool_del(pool);
+}
+BENCHMARK(BM_InternThenCompare)->Arg(1)->Arg(4)->Arg(16);
+
+static void BM_CStrEqRepeated(benchmark::State& state)
+{
+    const auto ncompares = static_cast<std::size_t>(state.range(0));
+    const auto symbols = MakeSymbols(4096);
+    const auto pairs   = MakePairs(symbols.size(), NPairs);
+    std::vector<cstr> b;
+    for (auto&& s : symbols) {
+        b.push_back(cstr_make(s.data(), s.size()));
+    }
+    int64_t count = 0;
+
+    for (auto _ : state) {
+        for (std::size_t i = 0; i < pairs.size(); i += 2) {
+            const std::string& s = symbols[pairs[i]];
+            cstr a = cstr_make(s.data(), s.size());
+            for (std::size_t k = 0; k < ncompares; ++k) {
+                count += cstr_eq(&a, &b[pairs[(i + 2 * k + 1) % pairs.size()]]);
+            }
+            cstr_destroy(&a);
+        }
+    }
+
+    if (count == 0) {
+        throw std::runtime_error("invalid!");
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(NPairs / 2 * ncompares));
+    for (auto& s : b) cstr_destroy(&s);
+}
+BENCHMARK(BM_CStrEqRepeated)->Arg(1)->Arg(4)->Arg(16);
+
+// lookups of names already in the pool, which take no lock
+static void BM_InternHit(benchmark::State& state)
+{
+    static cintern_pool* pool;
+    static std::vector<std::string> symbols;
+    if (state.thread_index() == 0) {
+        pool = cintern_pool_new();
+        symbols = MakeSymbols(4096);
+        for (auto&& s : symbols) {
+            cintern_intern(pool, cstrview_init(s.data(), s.size()));
+        }
+    }
+    std::size_t i = static_cast<std::size_t>(state.thread_index()) * 997;
+
+    for (auto _ : state) {
+        const std::string& s = symbols[i++ % symbols.size()];
+        benchmark::DoNotOptimize(cintern_intern(pool, cstrview_init(s.data(), s.size())));
+    }
+
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        cintern_pool_del(pool);
+    }
+}
+BENCHMARK(BM_InternHit)->ThreadRange(1, 4)->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,257 @@
+#define _GNU_SOURCE
+#include "cintern.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+
+// Each shard is an open addressing hash set of entry pointers, at most half
+// full, and an arena the entries are allocated from. Readers load the table
+// and its slots with acquire and never lock; writers hold the shard's lock,
+// fill in an entry before publishing it with a release store, and grow by
+// publishing a new table. Old tables are kept until the pool is deleted, as
+// readers may still be probing them; a reader that misses in an old table
+// just retries under the lock.
+
+struct cintern_table_t
+{
+    struct cintern_table_t* retired; // the table this one replaced
+    size_t                  mask;
+    cintern                 slots[];
+};
+
+struct cintern_block_t
+{
+    struct cintern_block_t* prev;
+};
+
+struct cintern_shard_t
+{
+    pthread_mutex_t         lock;
+    struct cintern_table_t* table;
+    size_t                  count;
+    struct cintern_block_t* blocks;
+    char*                   cur;
+    char*                   end;
+} __attribute__((aligned(64)));
+
+struct cintern_pool_t
+{
+    struct cintern_shard_t shards[CINTERN_SHARDS];
+};
+
+#define CINTERN_MIN_SLOTS_  64
+#define CINTERN_BLOCK_SIZE_ (64 * 1024)
+
+//------------------------------------------------------------------------------
+// hashing
+//------------------------------------------------------------------------------
+static uint64_t cintern_mix_(uint64_t h, uint64_t w)
+{
+    h = (h ^ w) * 0xff51afd7ed558ccdull;
+    return h ^ (h >> 32);
+}
+
+// 8 bytes at a time, finished with the murmur3 finalizer; the top bits pick
+// the shard and the bottom bits the slot
+static uint64_t cintern_hash_(const char* p, size_t n)
+{
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ n;
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h = cintern_mix_(h, w);
+    }
+    if (n > 0) {
+        uint64_t w = 0;
+        memcpy(&w, p, n);
+        h = cintern_mix_(h, w);
+    }
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return h;
+}
+
+static struct cintern_shard_t* cintern_shard_(const cintern_pool* p, uint64_t hash)
+{
+    return (struct cintern_shard_t*)&p->shards[hash >> 60];
+}
+
+//------------------------------------------------------------------------------
+// shard
+//------------------------------------------------------------------------------
+static struct cintern_table_t* cintern_table_new_(size_t nslots)
+{
+    struct cintern_table_t* t = (struct cintern_table_t*)calloc(
+            1, sizeof(*t) + nslots * sizeof(cintern));
+    if (t) {
+        t->mask = nslots - 1;
+    }
+    return t;
+}
+
+static cintern cintern_probe_(const struct cintern_table_t* t, uint64_t hash,
+                              const char* s, size_t n)
+{
+    for (size_t i = hash & t->mask;; i = (i + 1) & t->mask) {
+        cintern e = __atomic_load_n(&t->slots[i], __ATOMIC_ACQUIRE);
+        if (!e) {
+            return NULL;
+        }
+        if (e->hash == hash && e->len == n && memcmp(e->str, s, n) == 0) {
+            return e;
+        }
+    }
+}
+
+static void cintern_place_(struct cintern_table_t* t, cintern e)
+{
+    size_t i = e->hash & t->mask;
+    while (t->slots[i]) {
+        i = (i + 1) & t->mask;
+    }
+    __atomic_store_n(&t->slots[i], e, __ATOMIC_RELEASE);
+}
+
+// with the shard locked
+static int cintern_grow_(struct cintern_shard_t* sh)
+{
+    struct cintern_table_t* old = sh->table;
+    struct cintern_table_t* t = cintern_table_new_(2 * (old->mask + 1));
+    if (!t) {
+        return 0;
+    }
+    for (size_t i = 0; i <= old->mask; ++i) {
+        if (old->slots[i]) {
+            cintern_place_(t, old->slots[i]);
+        }
+    }
+    t->retired = old;
+    __atomic_store_n(&sh->table, t, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// with the shard locked
+static struct cintern_entry_t* cintern_alloc_(struct cintern_shard_t* sh, size_t n)
+{
+    const size_t need = (sizeof(struct cintern_entry_t) + n + 1 + 7) & ~(size_t)7;
+    if ((size_t)(sh->end - sh->cur) < need) {
+        const size_t size = need > CINTERN_BLOCK_SIZE_ ? need : CINTERN_BLOCK_SIZE_;
+        struct cintern_block_t* b = (struct cintern_block_t*)malloc(sizeof(*b) + size);
+        if (!b) {
+            return NULL;
+        }
+        b->prev = sh->blocks;
+        sh->blocks = b;
+        sh->cur = (char*)(b + 1);
+        sh->end = sh->cur + size;
+    }
+    struct cintern_entry_t* e = (struct cintern_entry_t*)sh->cur;
+    sh->cur += need;
+    return e;
+}
+
+//------------------------------------------------------------------------------
+// cintern_pool
+//------------------------------------------------------------------------------
+cintern_pool* cintern_pool_new(void)
+{
+    cintern_pool* p = (cintern_pool*)aligned_alloc(64, sizeof(*p));
+    if (!p) {
+        return NULL;
+    }
+    memset(p, 0, sizeof(*p));
+    for (int i = 0; i < CINTERN_SHARDS; ++i) {
+        struct cintern_shard_t* sh = &p->shards[i];
+        pthread_mutex_init(&sh->lock, NULL);
+        sh->table = cintern_table_new_(CINTERN_MIN_SLOTS_);
+        if (!sh->table) {
+            cintern_pool_del(p);
+            return NULL;
+        }
+    }
+    return p;
+}
+
+void cintern_pool_del(cintern_pool* p)
+{
+    if (!p) {
+        return;
+    }
+    for (int i = 0; i < CINTERN_SHARDS; ++i) {
+        struct cintern_shard_t* sh = &p->shards[i];
+        while (sh->table) {
+            struct cintern_table_t* retired = sh->table->retired;
+            free(sh->table);
+            sh->table = retired;
+        }
+        while (sh->blocks) {
+            struct cintern_block_t* prev = sh->blocks->prev;
+            free(sh->blocks);
+            sh->blocks = prev;
+        }
+        pthread_mutex_destroy(&sh->lock);
+    }
+    free(p);
+}
+
+size_t cintern_pool_size(const cintern_pool* p)
+{
+    size_t n = 0;
+    for (int i = 0; i < CINTERN_SHARDS; ++i) {
+        n += __atomic_load_n(&p->shards[i].count, __ATOMIC_RELAXED);
+    }
+    return n;
+}
+
+cintern cintern_find(const cintern_pool* p, cstrview v)
+{
+    const char*  s = cstrview_data(v);
+    const size_t n = cstrview_len(v);
+    const uint64_t hash = cintern_hash_(s, n);
+    const struct cintern_shard_t* sh = cintern_shard_(p, hash);
+    return cintern_probe_(__atomic_load_n(&sh->table, __ATOMIC_ACQUIRE), hash, s, n);
+}
+
+cintern cintern_intern(cintern_pool* p, cstrview v)
+{
+    const char*  s = cstrview_data(v);
+    const size_t n = cstrview_len(v);
+    const uint64_t hash = cintern_hash_(s, n);
+    struct cintern_shard_t* sh = cintern_shard_(p, hash);
+
+    cintern e = cintern_probe_(__atomic_load_n(&sh->table, __ATOMIC_ACQUIRE), hash, s, n);
+    if (e) {
+        return e;
+    }
+
+    pthread_mutex_lock(&sh->lock);
+    e = cintern_probe_(sh->table, hash, s, n);
+    if (!e && (2 * (sh->count + 1) <= sh->table->mask + 1 || cintern_grow_(sh))) {
+        struct cintern_entry_t* ne = cintern_alloc_(sh, n);
+        if (ne) {
+            ne->hash = hash;
+            ne->len  = n;
+            memcpy(ne->str, s, n);
+            ne->str[n] = '\0';
+            cintern_place_(sh->table, ne);
+            __atomic_store_n(&sh->count, sh->count + 1, __ATOMIC_RELAXED);
+            e = ne;
+        }
+    }
+    pthread_mutex_unlock(&sh->lock);
+    return e;
+}
+
+cintern cintern_intern_cstr(cintern_pool* p, const cstr* s)
+{
+    return cintern_intern(p, cstr_view(s));
+}
+
+int cintern_cmp(cintern a, cintern b)
+{
+    return a == b ? 0 : cstrview_cmp(cintern_view(a), cintern_view(b));
+}
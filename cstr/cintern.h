@@ -0,0 +1,57 @@
+#ifndef CINTERN__H_
+#define CINTERN__H_
+
+#include "cstr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// String interning: a pool keeps one copy of every distinct string given to
+// it and hands out a pointer to that copy, so two interned strings are equal
+// exactly when their handles are. The copies (NUL terminated, with their
+// length and hash in front) live in the pool's arenas and stay put until the
+// pool is deleted.
+//
+// The pool may be shared between threads: lookups of strings already interned
+// don't take a lock, new strings lock one of CINTERN_SHARDS shards.
+
+#define CINTERN_SHARDS 16
+
+struct cintern_entry_t
+{
+    uint64_t hash;
+    size_t   len;
+    char     str[];
+};
+typedef const struct cintern_entry_t* cintern;
+
+struct cintern_pool_t;
+typedef struct cintern_pool_t cintern_pool;
+
+// Initialization / Destruction
+cintern_pool* cintern_pool_new(void); // NULL if out of memory
+void          cintern_pool_del(cintern_pool* p);
+size_t        cintern_pool_size(const cintern_pool* p); // distinct strings
+
+// Interning, NULL if out of memory:
+cintern cintern_intern(cintern_pool* p, cstrview v);
+cintern cintern_intern_cstr(cintern_pool* p, const cstr* s);
+// NULL if `v` hasn't been interned
+cintern cintern_find(const cintern_pool* p, cstrview v);
+
+// Accessors, all O(1):
+static inline bool        cintern_eq(cintern a, cintern b) { return a == b; }
+static inline uint64_t    cintern_hash(cintern s) { return s->hash; }
+static inline size_t      cintern_len(cintern s) { return s->len; }
+static inline const char* cintern_str(cintern s) { return s->str; }
+static inline cstrview    cintern_view(cintern s) { return cstrview_init(s->str, s->len); }
+
+// Lexicographic, as cstrview_cmp()
+int cintern_cmp(cintern a, cintern b);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif // CINTERN__H_
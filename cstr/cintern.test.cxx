@@ -0,0 +1,120 @@
+#include <catch2/catch.hpp>
+#include <cintern.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+cstrview to_view(const std::string& s)
+{
+    return cstrview_init(s.data(), s.size());
+}
+
+std::string to_string(cintern s)
+{
+    return std::string{cintern_str(s), cintern_len(s)};
+}
+
+TEST_CASE("Interning")
+{
+    cintern_pool* pool = cintern_pool_new();
+    REQUIRE(pool != nullptr);
+
+    const std::string a = "AAPL";
+    const std::string b = "This is a symbol name that is too long to be inline";
+    const std::string c = std::string("with\0nul", 8);
+
+    CHECK(cintern_find(pool, to_view(a)) == nullptr);
+
+    cintern ia = cintern_intern(pool, to_view(a));
+    cintern ib = cintern_intern(pool, to_view(b));
+    cintern ic = cintern_intern(pool, to_view(c));
+    REQUIRE(ia != nullptr);
+    REQUIRE(ib != nullptr);
+    REQUIRE(ic != nullptr);
+    CHECK(cintern_pool_size(pool) == 3);
+
+    CHECK(to_string(ia) == a);
+    CHECK(to_string(ib) == b);
+    CHECK(to_string(ic) == c);
+    CHECK(cintern_str(ia)[a.size()] == '\0');
+
+    // a different copy of the same chars gives the same handle
+    const std::string a2 = a;
+    cstr sb = cstr_make(b.c_str(), b.size());
+    CHECK(cintern_intern(pool, to_view(a2)) == ia);
+    CHECK(cintern_intern_cstr(pool, &sb) == ib);
+    CHECK(cintern_find(pool, to_view(c)) == ic);
+    CHECK(cintern_pool_size(pool) == 3);
+    cstr_destroy(&sb);
+
+    CHECK(cintern_eq(ia, ia));
+    CHECK(!cintern_eq(ia, ib));
+    CHECK(cintern_hash(ia) != cintern_hash(ib));
+    CHECK(cintern_cmp(ia, ia) == 0);
+    CHECK(cintern_cmp(ia, ib) < 0);
+    CHECK(cintern_cmp(ib, ia) > 0);
+
+    cintern empty = cintern_intern(pool, to_view(""));
+    REQUIRE(empty != nullptr);
+    CHECK(cintern_len(empty) == 0);
+    CHECK(cintern_intern(pool, to_view("")) == empty);
+
+    cintern_pool_del(pool);
+}
+
+TEST_CASE("Handles are stable as the pool grows")
+{
+    cintern_pool* pool = cintern_pool_new();
+    REQUIRE(pool != nullptr);
+
+    std::vector<std::string> names;
+    std::vector<cintern> handles;
+    for (int i = 0; i < 100000; ++i) {
+        names.push_back("NYSE." + std::to_string(i) + (i % 3 == 0 ? ".a.longer.suffix" : ""));
+        handles.push_back(cintern_intern(pool, to_view(names.back())));
+        REQUIRE(handles.back() != nullptr);
+    }
+    CHECK(cintern_pool_size(pool) == names.size());
+
+    for (std::size_t i = 0; i < names.size(); ++i) {
+        CHECK(cintern_find(pool, to_view(names[i])) == handles[i]);
+        CHECK(to_string(handles[i]) == names[i]);
+    }
+
+    cintern_pool_del(pool);
+}
+
+TEST_CASE("Threads interning the same strings get the same handles")
+{
+    cintern_pool* pool = cintern_pool_new();
+    REQUIRE(pool != nullptr);
+
+    constexpr int nthreads = 4;
+    constexpr int nnames   = 20011; // prime, so every order below is a permutation
+    std::vector<std::vector<cintern>> handles(nthreads, std::vector<cintern>(nnames));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < nthreads; ++t) {
+        threads.emplace_back([&, t] {
+            // each thread in a different order
+            for (int k = 0; k < nnames; ++k) {
+                const int i = (k * (2 * t + 1)) % nnames;
+                const std::string name = "sym" + std::to_string(i);
+                handles[t][i] = cintern_intern(pool, to_view(name));
+            }
+        });
+    }
+    for (auto& th : threads) {
+        th.join();
+    }
+
+    CHECK(cintern_pool_size(pool) == nnames);
+    for (int i = 0; i < nnames; ++i) {
+        REQUIRE(handles[0][i] != nullptr);
+        CHECK(to_string(handles[0][i]) == "sym" + std::to_string(i));
+        for (int t = 1; t < nthreads; ++t) {
+            CHECK(handles[t][i] == handles[0][i]);
+        }
+    }
+
+    cintern_pool_del(pool);
+}
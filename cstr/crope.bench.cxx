@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+#include <stdexcept>
+
+#include "crope.h"
+
+#include <random>
+#include <string>
+
+// Cost of one small insert into a document of 1 KB to 100 MB: O(n) memmove
+// (and usually a realloc) for cstr, O(log n) for crope. The document is
+// rebuilt, untimed, whenever it has grown by an eighth.
+
+static const char Snippet[] = "<p>inserted</p>\n";
+
+static std::string MakeDocument(std::size_t n)
+{
+    std::string doc;
+    doc.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        doc.push_back(static_cast<char>('a' + i % 26));
+    }
+    return doc;
+}
+
+void DocInsert(cstr& a, std::size_t pos, cstrview v) { cstr_insertv(&a, pos, v); }
+void DocInsert(crope& a, std::size_t pos, cstrview v) { crope_insertv(&a, pos, v); }
+
+auto DocSize(const cstr&  a) { return cstr_len(&a); }
+auto DocSize(const crope& a) { return crope_len(&a); }
+
+void DocInit(cstr& a, const std::string& s) { a = cstr_make(s.data(), s.size()); }
+void DocInit(crope& a, const std::string& s) { crope_init(&a, cstrview_init(s.data(), s.size())); }
+
+void DocDestroy(cstr& a) { cstr_destroy(&a); }
+void DocDestroy(crope& a) { crope_destroy(&a); }
+
+template <class Doc>
+static void BM_InsertRandom(benchmark::State& state)
+{
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const cstrview snippet = cstrview_init(Snippet, sizeof(Snippet) - 1);
+    std::mt19937_64 gen(42);
+    const std::string base = MakeDocument(n);
+    Doc doc;
+    DocInit(doc, base);
+
+    for (auto _ : state) {
+        const std::size_t pos = gen() % (DocSize(doc) + 1);
+        DocInsert(doc, pos, snippet);
+        if (DocSize(doc) > n + n / 8) {
+            state.PauseTiming();
+            DocDestroy(doc);
+            DocInit(doc, base);
+            state.ResumeTiming();
+        }
+    }
+
+    if (DocSize(doc) < n) {
+        throw std::runtime_error("invalid!");
+    }
+    DocDestroy(doc);
+}
+
+template <class Doc>
+static void BM_Prepend(benchmark::State& state)
+{
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const cstrview snippet = cstrview_init(Snippet, sizeof(Snippet) - 1);
+    const std::string base = MakeDocument(n);
+    Doc doc;
+    DocInit(doc, base);
+
+    for (auto _ : state) {
+        DocInsert(doc, 0, snippet);
+        if (DocSize(doc) > n + n / 8) {
+            state.PauseTiming();
+            DocDestroy(doc);
+            DocInit(doc, base);
+            state.ResumeTiming();
+        }
+    }
+
+    if (DocSize(doc) < n) {
+        throw std::runtime_error("invalid!");
+    }
+    DocDestroy(doc);
+}
+
+static void DocumentSizes(benchmark::internal::Benchmark* b)
+{
+    for (int64_t n : { 1<<10, 16<<10, 256<<10, 4<<20, 100<<20 }) {
+        b->Arg(n);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_InsertRandom, cstr)->Apply(DocumentSizes);
+BENCHMARK_TEMPLATE(BM_InsertRandom, crope)->Apply(DocumentSizes);
+BENCHMARK_TEMPLATE(BM_Prepend, cstr)->Apply(DocumentSizes);
+BENCHMARK_TEMPLATE(BM_Prepend, crope)->Apply(DocumentSizes);
+
+// flattening is the price paid for a contiguous string at the end
+static void BM_Flatten(benchmark::State& state)
+{
+    const auto n = static_cast<std::size_t>(state.range(0));
+    crope doc;
+    DocInit(doc, MakeDocument(n));
+
+    for (auto _ : state) {
+        cstr flat = crope_flatten(&doc);
+        benchmark::DoNotOptimize(cstr_str(&flat));
+        cstr_destroy(&flat);
+    }
+
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+    crope_destroy(&doc);
+}
+BENCHMARK(BM_Flatten)->Apply(DocumentSizes);
+
+BENCHMARK_MAIN();
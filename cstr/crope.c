@@ -0,0 +1,349 @@
+#include "crope.h"
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <errno.h>
+
+struct crope_node_t
+{
+    struct crope_node_t* left;
+    struct crope_node_t* right;
+    size_t               size;   // chars in this subtree
+    uint32_t             height;
+    uint32_t             len;    // chars in this node's chunk
+    char                 data[];
+};
+
+// nodes are allocated 1 KB at a time, header included
+#define CROPE_NODE_SIZE_ 1024
+#define CROPE_CHUNK_     (CROPE_NODE_SIZE_ - sizeof(struct crope_node_t))
+
+//------------------------------------------------------------------------------
+// AVL tree
+//------------------------------------------------------------------------------
+static size_t crope_size_(const struct crope_node_t* n)
+{
+    return n ? n->size : 0;
+}
+
+static uint32_t crope_height_(const struct crope_node_t* n)
+{
+    return n ? n->height : 0;
+}
+
+static void crope_update_(struct crope_node_t* n)
+{
+    const uint32_t hl = crope_height_(n->left);
+    const uint32_t hr = crope_height_(n->right);
+    n->size   = crope_size_(n->left) + n->len + crope_size_(n->right);
+    n->height = 1 + (hl > hr ? hl : hr);
+}
+
+static struct crope_node_t* crope_rotate_right_(struct crope_node_t* n)
+{
+    struct crope_node_t* l = n->left;
+    n->left  = l->right;
+    l->right = n;
+    crope_update_(n);
+    crope_update_(l);
+    return l;
+}
+
+static struct crope_node_t* crope_rotate_left_(struct crope_node_t* n)
+{
+    struct crope_node_t* r = n->right;
+    n->right = r->left;
+    r->left  = n;
+    crope_update_(n);
+    crope_update_(r);
+    return r;
+}
+
+static struct crope_node_t* crope_rebalance_(struct crope_node_t* n)
+{
+    crope_update_(n);
+    const uint32_t hl = crope_height_(n->left);
+    const uint32_t hr = crope_height_(n->right);
+    if (hl > hr + 1) {
+        if (crope_height_(n->left->right) > crope_height_(n->left->left)) {
+            n->left = crope_rotate_left_(n->left);
+        }
+        return crope_rotate_right_(n);
+    }
+    if (hr > hl + 1) {
+        if (crope_height_(n->right->left) > crope_height_(n->right->right)) {
+            n->right = crope_rotate_right_(n->right);
+        }
+        return crope_rotate_left_(n);
+    }
+    return n;
+}
+
+// insert `nn` so that its chunk starts at `pos`, which has to be a chunk
+// boundary of `t`
+static struct crope_node_t* crope_insert_node_(struct crope_node_t* t, size_t pos,
+                                               struct crope_node_t* nn)
+{
+    if (!t) {
+        nn->left = nn->right = NULL;
+        crope_update_(nn);
+        return nn;
+    }
+    const size_t ls = crope_size_(t->left);
+    if (pos <= ls) {
+        t->left = crope_insert_node_(t->left, pos, nn);
+    } else {
+        assert(pos >= ls + t->len);
+        t->right = crope_insert_node_(t->right, pos - ls - t->len, nn);
+    }
+    return crope_rebalance_(t);
+}
+
+static void crope_free_(struct crope_node_t* t)
+{
+    while (t) {
+        struct crope_node_t* right = t->right;
+        crope_free_(t->left);
+        free(t);
+        t = right;
+    }
+}
+
+// append chars [pos, pos + len) of `t` to `out`, which has the capacity
+static void crope_copy_(const struct crope_node_t* t, size_t pos, size_t len, cstr* out)
+{
+    while (t && len > 0) {
+        const size_t ls = crope_size_(t->left);
+        if (pos < ls) {
+            const size_t n = ls - pos < len ? ls - pos : len;
+            crope_copy_(t->left, pos, n, out);
+            len -= n;
+            pos  = ls;
+        }
+        pos -= ls;
+        if (len > 0 && pos < t->len) {
+            const size_t n = t->len - pos < len ? t->len - pos : len;
+            cstr_appendv(out, cstrview_init(&t->data[pos], n));
+            len -= n;
+            pos  = t->len;
+        }
+        pos -= t->len;
+        t = t->right;
+    }
+}
+
+//------------------------------------------------------------------------------
+// crope
+//------------------------------------------------------------------------------
+crope* crope_init(crope* r, cstrview v)
+{
+    r->root = NULL;
+    return crope_insertv(r, 0, v) ? r : NULL;
+}
+
+void crope_destroy(crope* r)
+{
+    crope_free_(r->root);
+    r->root = NULL;
+}
+
+size_t crope_len(const crope* r)
+{
+    return crope_size_(r->root);
+}
+
+bool crope_empty(const crope* r)
+{
+    return crope_len(r) == 0;
+}
+
+char crope_at(const crope* r, size_t pos)
+{
+    const struct crope_node_t* t = r->root;
+    assert(pos < crope_len(r));
+    for (;;) {
+        const size_t ls = crope_size_(t->left);
+        if (pos < ls) {
+            t = t->left;
+        } else if (pos - ls < t->len) {
+            return t->data[pos - ls];
+        } else {
+            pos -= ls + t->len;
+            t = t->right;
+        }
+    }
+}
+
+// Inserting at a chunk boundary extends the chunk before it. When `v` fits in
+// the chunk it goes there; otherwise the chunk keeps its head and as much of
+// `v` as fits, and the rest of `v` and the chunk's old tail become new nodes.
+// All of those are allocated up front, so running out of memory changes
+// nothing.
+crope* crope_insertv(crope* r, size_t pos, cstrview v)
+{
+    const char* src = cstrview_data(v);
+    size_t m = cstrview_len(v);
+    if (pos > crope_len(r)) {
+        errno = ERANGE;
+        return NULL;
+    }
+    if (m == 0) {
+        return r;
+    }
+
+    // find the chunk, remembering the path to fix up subtree sizes
+    struct crope_node_t* path[CROPE_MAX_HEIGHT];
+    int depth = 0;
+    struct crope_node_t* x = r->root;
+    size_t off = pos;
+    while (x) {
+        path[depth++] = x;
+        const size_t ls = crope_size_(x->left);
+        if (off < ls) {
+            x = x->left;
+        } else if (off - ls <= x->len) {
+            off -= ls;
+            break;
+        } else {
+            off -= ls + x->len;
+            x = x->right;
+        }
+    }
+
+    if (x && x->len + m <= CROPE_CHUNK_) {
+        memmove(&x->data[off + m], &x->data[off], x->len - off);
+        memcpy(&x->data[off], src, m);
+        x->len += (uint32_t)m;
+        for (int i = 0; i < depth; ++i) {
+            path[i]->size += m;
+        }
+        return r;
+    }
+
+    const size_t head = x ? off : 0;
+    const size_t tail = x ? x->len - off : 0;
+    const size_t fill = x ? (CROPE_CHUNK_ - head < m ? CROPE_CHUNK_ - head : m) : 0;
+    const size_t rest = m - fill;
+    const size_t last = rest % CROPE_CHUNK_ ? rest % CROPE_CHUNK_ : CROPE_CHUNK_;
+    size_t pieces = (rest + CROPE_CHUNK_ - 1) / CROPE_CHUNK_;
+    const int tail_fits = pieces > 0 && last + tail <= CROPE_CHUNK_;
+    const size_t nnodes = pieces + (tail > 0 && !tail_fits);
+
+    struct crope_node_t* fresh = NULL;
+    for (size_t i = 0; i < nnodes; ++i) {
+        struct crope_node_t* n = (struct crope_node_t*)malloc(CROPE_NODE_SIZE_);
+        if (!n) {
+            crope_free_(fresh);
+            return NULL;
+        }
+        n->right = fresh;
+        n->left  = NULL;
+        fresh = n;
+    }
+
+    // the old tail moves to the last new node
+    char tailbuf[CROPE_NODE_SIZE_];
+    if (x) {
+        memcpy(tailbuf, &x->data[off], tail);
+        memcpy(&x->data[off], src, fill);
+        x->len = (uint32_t)(head + fill);
+        for (int i = 0; i < depth; ++i) {
+            path[i]->size = path[i]->size + fill - tail;
+        }
+        src += fill;
+    }
+
+    size_t at = pos + fill;
+    while (fresh) {
+        struct crope_node_t* n = fresh;
+        fresh = fresh->right;
+        if (pieces > 0) {
+            const size_t len = pieces == 1 ? last : CROPE_CHUNK_;
+            memcpy(n->data, src, len);
+            n->len = (uint32_t)len;
+            src += len;
+            if (--pieces == 0 && tail_fits) {
+                memcpy(&n->data[len], tailbuf, tail);
+                n->len += (uint32_t)tail;
+            }
+        } else {
+            memcpy(n->data, tailbuf, tail);
+            n->len = (uint32_t)tail;
+        }
+        r->root = crope_insert_node_(r->root, at, n);
+        at += n->len;
+    }
+    assert(crope_height_(r->root) < CROPE_MAX_HEIGHT);
+    return r;
+}
+
+crope* crope_appendv(crope* r, cstrview v)
+{
+    return crope_insertv(r, crope_len(r), v);
+}
+
+crope* crope_prependv(crope* r, cstrview v)
+{
+    return crope_insertv(r, 0, v);
+}
+
+cstr crope_substr(const crope* r, size_t pos, size_t len)
+{
+    const size_t size = crope_len(r);
+    const size_t i = pos < size ? pos : size;
+    const size_t n = len < size - i ? len : size - i;
+    cstr s = cstr_make("", 0);
+    if (cstr_reserve(&s, n)) {
+        crope_copy_(r->root, i, n, &s);
+    }
+    return s;
+}
+
+cstr crope_flatten(const crope* r)
+{
+    return crope_substr(r, 0, crope_len(r));
+}
+
+//------------------------------------------------------------------------------
+// crope_iter
+//------------------------------------------------------------------------------
+static void crope_iter_descend_(crope_iter* it, const struct crope_node_t* t)
+{
+    for (; t; t = t->left) {
+        it->stack[it->depth++] = t;
+    }
+}
+
+static void crope_iter_load_(crope_iter* it)
+{
+    if (it->depth > 0) {
+        const struct crope_node_t* t = it->stack[it->depth - 1];
+        it->value = cstrview_init(t->data, t->len);
+    } else {
+        it->value = cstrview_init(NULL, 0);
+    }
+}
+
+void crope_iter_start(crope_iter* it, const crope* r)
+{
+    it->depth = 0;
+    crope_iter_descend_(it, r->root);
+    crope_iter_load_(it);
+}
+
+void crope_iter_next(crope_iter* it)
+{
+    const struct crope_node_t* t = it->stack[--it->depth];
+    crope_iter_descend_(it, t->right);
+    crope_iter_load_(it);
+}
+
+bool crope_iter_stop(const crope_iter* it)
+{
+    return it->depth == 0;
+}
+
+cstrview crope_iter_deref(const crope_iter* it)
+{
+    return it->value;
+}
@@ -0,0 +1,65 @@
+#ifndef CROPE__H_
+#define CROPE__H_
+
+#include "cstr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// A rope: the string is kept in chunks of up to about 1 KB, one per node of an
+// AVL tree ordered by position, where each node also knows the length of its
+// subtree. Inserting anywhere costs O(log n) plus moving at most one chunk,
+// instead of the O(n) memmove of cstr_insertv() / cstr_prependv(). Text is
+// read back a chunk at a time through crope_iter, or copied out into a cstr.
+
+// bounds the height of the tree: an AVL tree with 2^64 nodes is lower than this
+#define CROPE_MAX_HEIGHT 96
+
+struct crope_node_t;
+
+struct crope_t
+{
+    struct crope_node_t* root;
+};
+typedef struct crope_t crope;
+
+#define CROPE_EMPTY { NULL }
+
+struct crope_iter_t
+{
+    const struct crope_node_t* stack[CROPE_MAX_HEIGHT];
+    int                        depth;
+    cstrview                   value;
+};
+typedef struct crope_iter_t crope_iter;
+
+// Initialization / Destruction
+crope* crope_init(crope* r, cstrview v); // NULL if out of memory
+void   crope_destroy(crope* r);
+
+// Length Accessors:
+size_t crope_len(const crope* r);
+bool   crope_empty(const crope* r);
+char   crope_at(const crope* r, size_t pos); // pos < crope_len(r)
+
+// Mutators, returning NULL and leaving `r` as it was on failure:
+crope* crope_insertv(crope* r, size_t pos, cstrview v); // insert `v` at position `pos`
+crope* crope_appendv(crope* r, cstrview v);
+crope* crope_prependv(crope* r, cstrview v);
+
+// Copies, as a cstr (empty if out of memory):
+cstr crope_substr(const crope* r, size_t pos, size_t len);
+cstr crope_flatten(const crope* r);
+
+// Chunk iterator: the chunks of `r` in order, as views
+void     crope_iter_start(crope_iter* it, const crope* r);
+void     crope_iter_next(crope_iter* it);
+bool     crope_iter_stop(const crope_iter* it);
+cstrview crope_iter_deref(const crope_iter* it);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif
+
+#endif // CROPE__H_
@@ -0,0 +1,125 @@
+#include <catch2/catch.hpp>
+#include <crope.h>
+#include <cerrno>
+#include <random>
+#include <string>
+
+std::string to_string(const cstr* s)
+{
+    return std::string{cstr_str(s), cstr_len(s)};
+}
+
+std::string to_string(const crope* r)
+{
+    std::string result;
+    crope_iter it;
+    for (crope_iter_start(&it, r); !crope_iter_stop(&it); crope_iter_next(&it)) {
+        cstrview v = crope_iter_deref(&it);
+        CHECK(!cstrview_empty(v));
+        result.append(cstrview_data(v), cstrview_len(v));
+    }
+    return result;
+}
+
+cstrview to_view(const std::string& s)
+{
+    return cstrview_init(s.data(), s.size());
+}
+
+TEST_CASE("Empty rope")
+{
+    crope r = CROPE_EMPTY;
+    CHECK(crope_len(&r) == 0);
+    CHECK(crope_empty(&r));
+    CHECK(to_string(&r) == "");
+
+    cstr s = crope_flatten(&r);
+    CHECK(cstr_len(&s) == 0);
+    cstr_destroy(&s);
+
+    REQUIRE(crope_insertv(&r, 0, to_view("")) == &r);
+    CHECK(crope_empty(&r));
+    crope_destroy(&r);
+}
+
+TEST_CASE("Insert out of range")
+{
+    crope r;
+    REQUIRE(crope_init(&r, to_view("Hello")) == &r);
+    errno = 0;
+    CHECK(crope_insertv(&r, 6, to_view("!")) == nullptr);
+    CHECK(errno == ERANGE);
+    CHECK(to_string(&r) == "Hello");
+    crope_destroy(&r);
+}
+
+TEST_CASE("Rope matches std::string")
+{
+    // inserts of every size from a char to several chunks, at the front, the
+    // back and random positions
+    std::mt19937 gen(42);
+    std::string text;
+    for (int i = 0; i < 5000; ++i) {
+        text.push_back(static_cast<char>('a' + i % 26));
+    }
+
+    crope r = CROPE_EMPTY;
+    std::string expect;
+
+    for (int i = 0; i < 2000; ++i) {
+        const std::size_t len = std::uniform_int_distribution<std::size_t>(0, i % 10 == 0 ? 4000 : 40)(gen);
+        const std::size_t off = std::uniform_int_distribution<std::size_t>(0, text.size() - len)(gen);
+        const std::string piece = text.substr(off, len);
+        std::size_t pos;
+        switch (i % 4) {
+        case 0:  pos = 0; break;
+        case 1:  pos = expect.size(); break;
+        default: pos = std::uniform_int_distribution<std::size_t>(0, expect.size())(gen); break;
+        }
+        INFO("i=" << i << " pos=" << pos << " len=" << len);
+
+        REQUIRE(crope_insertv(&r, pos, to_view(piece)) == &r);
+        expect.insert(pos, piece);
+        REQUIRE(crope_len(&r) == expect.size());
+
+        if (i % 100 == 0) {
+            CHECK(to_string(&r) == expect);
+        }
+    }
+
+    CHECK(to_string(&r) == expect);
+
+    cstr flat = crope_flatten(&r);
+    CHECK(to_string(&flat) == expect);
+    cstr_destroy(&flat);
+
+    for (std::size_t pos = 0; pos < expect.size(); pos += 997) {
+        CHECK(crope_at(&r, pos) == expect[pos]);
+        cstr sub = crope_substr(&r, pos, 3000);
+        CHECK(to_string(&sub) == expect.substr(pos, 3000));
+        cstr_destroy(&sub);
+    }
+
+    cstr past_end = crope_substr(&r, expect.size() + 1, 10);
+    CHECK(cstr_len(&past_end) == 0);
+    cstr_destroy(&past_end);
+
+    crope_destroy(&r);
+    CHECK(crope_empty(&r));
+}
+
+TEST_CASE("Append and prepend")
+{
+    crope r;
+    REQUIRE(crope_init(&r, to_view("middle")) == &r);
+    std::string expect = "middle";
+    for (int i = 0; i < 1000; ++i) {
+        const std::string s = std::to_string(i);
+        REQUIRE(crope_prependv(&r, to_view(s)) == &r);
+        REQUIRE(crope_appendv(&r, to_view(s)) == &r);
+        expect = s + expect + s;
+    }
+    CHECK(crope_len(&r) == expect.size());
+    CHECK(to_string(&r) == expect);
+    crope_destroy(&r);
+}
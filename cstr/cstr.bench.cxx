@@ -7,6 +7,8 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
+#include <algorithm>
 #include <cstring>
 
 void StringAppend(std::string& a, const std::string& b) { a += b; }
@@ -21,6 +23,12 @@ void StringInsert(cstr& a, std::size_t index, const cstr& b) { cstr_insert(&a, i
 auto StringSize(const std::string& a) { return a.size(); }
 auto StringSize(const cstr&        a) { return cstr_len(&a); }
 
+auto StringEq(const std::string& a, const std::string& b) { return a == b; }
+auto StringEq(const cstr&        a, const cstr&        b) { return cstr_eq(&a, &b) != 0; }
+
+auto StringCmp(const std::string& a, const std::string& b) { return a.compare(b); }
+auto StringCmp(const cstr&        a, const cstr&        b) { return cstr_cmp(&a, &b); }
+
 template <class T>
 T make(const char* const s) { return T{s, strlen(s)}; };
 
@@ -193,4 +201,281 @@ static void BM_InsertLongStrings(benchmark::State& state)
 BENCHMARK_TEMPLATE(BM_InsertLongStrings, cstr);
 BENCHMARK_TEMPLATE(BM_InsertLongStrings, std::string);
 
+// 20-23 chars: inline in cstr (up to 23), on the heap in std::string (up
+// to 15 with libstdc++)
+static constexpr const char* MediumString = "The quick brown fox jum";
+
+template <class String>
+static void BM_AppendMediumStrings(benchmark::State& state)
+{
+    const auto len = static_cast<std::size_t>(state.range(0));
+    std::vector<String> strings;
+    for (std::size_t i = 0; i < len; i += 6) {
+        const std::size_t n = len - i < 6 ? len - i : 6;
+        strings.push_back(make<String>(std::string(MediumString + i, n).c_str()));
+    }
+    int64_t count = 0;
+
+    for (auto _ : state) {
+        String result = {};
+        for (auto&& s : strings) {
+            StringAppend(result, s);
+        }
+        count += StringSize(result);
+        benchmark::DoNotOptimize(result);
+    }
+
+    if (count != static_cast<int64_t>(state.iterations() * len)) {
+        throw std::runtime_error("invalid!");
+    }
+}
+BENCHMARK_TEMPLATE(BM_AppendMediumStrings, cstr)->DenseRange(20, 23);
+BENCHMARK_TEMPLATE(BM_AppendMediumStrings, std::string)->DenseRange(20, 23);
+
+// equal strings, and strings that only differ in the last char
+template <class String>
+static void BM_CompareMediumStrings(benchmark::State& state)
+{
+    const auto len = static_cast<std::size_t>(state.range(0));
+    std::string other(MediumString, len);
+    other.back() = '\001';
+    const String a = make<String>(std::string(MediumString, len).c_str());
+    const String b = make<String>(std::string(MediumString, len).c_str());
+    const String c = make<String>(other.c_str());
+    int64_t count = 0;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(&a);
+        benchmark::DoNotOptimize(&b);
+        benchmark::DoNotOptimize(&c);
+        count += StringEq(a, b);
+        count += StringEq(a, c);
+        count += StringCmp(a, c) > 0;
+    }
+
+    if (count != 2 * static_cast<int64_t>(state.iterations())) {
+        throw std::runtime_error("invalid!");
+    }
+}
+BENCHMARK_TEMPLATE(BM_CompareMediumStrings, cstr)->DenseRange(20, 23);
+BENCHMARK_TEMPLATE(BM_CompareMediumStrings, std::string)->DenseRange(20, 23);
+
+// A request handler's strings: built from a few pieces, some too long to be
+// inline, then all thrown away together. Freed one by one with malloc, or all
+// at once by resetting an arena.
+static const char* const RequestPieces[] = {
+    "GET ", "/api/v1/orders/", "8675309", "?fields=id,price,qty", " HTTP/1.1",
+};
+
+static void BuildRequestStrings(std::vector<cstr>& strs, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        cstr s = make<cstr>(RequestPieces[0]);
+        for (std::size_t j = 1; j <= i % 5; ++j) {
+            cstr_appendv(&s, cstrview_init(RequestPieces[j], strlen(RequestPieces[j])));
+        }
+        strs.push_back(s);
+    }
+}
+
+static void BM_BuildAndDiscard_Malloc(benchmark::State& state)
+{
+    const auto n = static_cast<std::size_t>(state.range(0));
+    std::vector<cstr> strs;
+    strs.reserve(n);
+    int64_t count = 0;
+
+    for (auto _ : state) {
+        BuildRequestStrings(strs, n);
+        count += static_cast<int64_t>(cstr_len(&strs.back()));
+        for (auto& s : strs) {
+            cstr_destroy(&s);
+        }
+        strs.clear();
+    }
+
+    if (count == 0) {
+        throw std::runtime_error("invalid!");
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+}
+BENCHMARK(BM_BuildAndDiscard_Malloc)->RangeMultiplier(8)->Range(8, 8<<12);
+
+static void BM_BuildAndDiscard_Arena(benchmark::State& state)
+{
+    const auto n = static_cast<std::size_t>(state.range(0));
+    std::vector<cstr> strs;
+    strs.reserve(n);
+    cstr_arena arena;
+    cstr_arena_init(&arena, 64 * 1024);
+    int64_t count = 0;
+
+    for (auto _ : state) {
+        cstr_arena_begin(&arena);
+        BuildRequestStrings(strs, n);
+        count += static_cast<int64_t>(cstr_len(&strs.back()));
+        strs.clear();
+        cstr_arena_end(&arena);
+        cstr_arena_reset(&arena);
+    }
+
+    cstr_arena_release(&arena);
+    if (count == 0) {
+        throw std::runtime_error("invalid!");
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(n));
+}
+BENCHMARK(BM_BuildAndDiscard_Arena)->RangeMultiplier(8)->Range(8, 8<<12);
+
+// cstrview search against std::string_view, over `n` bytes of text with the
+// char or substring being looked for at the very end
+static std::string MakeText(std::size_t n)
+{
+    std::string text;
+    for (std::size_t i = 0; i < n; ++i) {
+        text.push_back(static_cast<char>('a' + i % 23));
+    }
+    return text;
+}
+
+static void BM_FindChar_CStrView(benchmark::State& state)
+{
+    std::string text = MakeText(static_cast<std::size_t>(state.range(0)));
+    text.back() = '|';
+    const cstrview v = cstrview_init(text.data(), text.size());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(cstrview_split(v, '|'));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FindChar_CStrView)->RangeMultiplier(8)->Range(16, 4<<20);
+
+static void BM_FindChar_StringView(benchmark::State& state)
+{
+    std::string text = MakeText(static_cast<std::size_t>(state.range(0)));
+    text.back() = '|';
+    const std::string_view v = text;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(v.find('|'));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FindChar_StringView)->RangeMultiplier(8)->Range(16, 4<<20);
+
+static void BM_FindSubstring_CStrView(benchmark::State& state)
+{
+    std::string text = MakeText(static_cast<std::size_t>(state.range(0)));
+    text.replace(text.size() - 6, 6, "price=");
+    const cstrview v = cstrview_init(text.data(), text.size());
+    const cstrview needle = cstrview_init("price=", 6);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(cstrview_split_on(v, needle));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FindSubstring_CStrView)->RangeMultiplier(8)->Range(64, 4<<20);
+
+static void BM_FindSubstring_StringView(benchmark::State& state)
+{
+    std::string text = MakeText(static_cast<std::size_t>(state.range(0)));
+    text.replace(text.size() - 6, 6, "price=");
+    const std::string_view v = text;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(v.find("price="));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FindSubstring_StringView)->RangeMultiplier(8)->Range(64, 4<<20);
+
+// a multi-MB payload of short '\001' separated fields
+static std::string MakeFields(std::size_t n)
+{
+    std::string text;
+    for (std::size_t i = 0; text.size() < n; ++i) {
+        text += std::to_string(i % 1000) + "=" + MakeText(1 + i % 17) + '\001';
+    }
+    return text;
+}
+
+static void BM_Tokenize_CStrView(benchmark::State& state)
+{
+    const std::string text = MakeFields(static_cast<std::size_t>(state.range(0)));
+    int64_t count = 0;
+
+    for (auto _ : state) {
+        cstrview_split_iter it = cstrview_split_start(cstrview_init(text.data(), text.size()), '\001');
+        for (; !cstrview_split_stop(it); it = cstrview_split_next(it, '\001')) {
+            count += static_cast<int64_t>(cstrview_len(cstrview_split_deref(it)));
+        }
+    }
+
+    if (count == 0) {
+        throw std::runtime_error("invalid!");
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_Tokenize_CStrView)->Arg(4<<20);
+
+static void BM_Tokenize_StringView(benchmark::State& state)
+{
+    const std::string text = MakeFields(static_cast<std::size_t>(state.range(0)));
+    int64_t count = 0;
+
+    for (auto _ : state) {
+        std::string_view v = text;
+        while (!v.empty()) {
+            const std::size_t n = std::min(v.find('\001'), v.size());
+            count += static_cast<int64_t>(n);
+            v.remove_prefix(std::min(n + 1, v.size()));
+        }
+    }
+
+    if (count == 0) {
+        throw std::runtime_error("invalid!");
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(text.size()));
+}
+BENCHMARK(BM_Tokenize_StringView)->Arg(4<<20);
+
+// equal up to the last byte
+static void BM_Compare_CStrView(benchmark::State& state)
+{
+    const std::string a = MakeText(static_cast<std::size_t>(state.range(0)));
+    std::string b = a;
+    b.back() = '~';
+    const cstrview v = cstrview_init(a.data(), a.size());
+    const cstrview w = cstrview_init(b.data(), b.size());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(cstrview_cmp(v, w));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Compare_CStrView)->RangeMultiplier(8)->Range(16, 4<<20);
+
+static void BM_Compare_StringView(benchmark::State& state)
+{
+    const std::string a = MakeText(static_cast<std::size_t>(state.range(0)));
+    std::string b = a;
+    b.back() = '~';
+    const std::string_view v = a;
+    const std::string_view w = b;
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(v);
+        benchmark::DoNotOptimize(v.compare(w));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Compare_StringView)->RangeMultiplier(8)->Range(16, 4<<20);
+
 BENCHMARK_MAIN();
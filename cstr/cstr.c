@@ -1,5 +1,6 @@
 #define _GNU_SOURCE
 #include "cstr.h"
+#include "cstr_simd.h"
 #include <string.h>
 #include <stdlib.h>
 #include <assert.h>
@@ -54,24 +55,32 @@ static struct cstr_alloc_t cstr_allocator_ = {
     .free         = &cstr_free_,
 };
 
+// innermost scope on this thread, see cstr_scope_begin()
+static __thread cstr_scope* cstr_scope_ = NULL;
+
+static const struct cstr_alloc_t* allocator_(void)
+{
+    return cstr_scope_ ? &cstr_scope_->alloc : &cstr_allocator_;
+}
+
 static void* calloc_(size_t nmemb, size_t size)
 {
-    return cstr_allocator_.calloc(nmemb, size);
+    return allocator_()->calloc(nmemb, size);
 }
 
 static void* reallocarray_(void* p, size_t nmemb, size_t size)
 {
-    return cstr_allocator_.reallocarray(p, nmemb, size);
+    return allocator_()->reallocarray(p, nmemb, size);
 }
 
 static void free_(void* p, size_t size)
 {
-    cstr_allocator_.free(p, size);
+    allocator_()->free(p, size);
 }
 
 static void* calloc_using_reallocarray_(size_t nmemb, size_t size)
 {
-    void* p = cstr_allocator_.reallocarray(NULL, nmemb, size);
+    void* p = allocator_()->reallocarray(NULL, nmemb, size);
     if (p == NULL) {
         return p;
     }
@@ -115,6 +124,217 @@ static void* reallocarray_using_calloc_(void* p, size_t nmemb, size_t size)
 }
 #endif
 
+//------------------------------------------------------------------------------
+// cstr_arena
+//------------------------------------------------------------------------------
+struct cstr_arena_block_t
+{
+    struct cstr_arena_block_t* prev;
+    size_t                     size;
+};
+
+// every allocation is preceded by its size, so realloc knows how much to copy
+#define CSTR_ARENA_ALIGN_ sizeof(size_t)
+
+static size_t cstr_arena_round_(size_t n)
+{
+    return (n + CSTR_ARENA_ALIGN_ - 1) & ~(CSTR_ARENA_ALIGN_ - 1);
+}
+
+static size_t* cstr_arena_header_(void* p)
+{
+    return (size_t*)p - 1;
+}
+
+static int cstr_arena_grow_(cstr_arena* a, size_t need)
+{
+    const size_t size = need > a->block_size ? need : a->block_size;
+    struct cstr_arena_block_t* block =
+        (struct cstr_arena_block_t*)malloc(sizeof(*block) + size);
+    if (!block) {
+        return 0;
+    }
+    block->prev = a->head;
+    block->size = size;
+    a->head = block;
+    a->cur  = (char*)(block + 1);
+    a->end  = a->cur + size;
+    return 1;
+}
+
+static void* cstr_arena_alloc_(cstr_arena* a, size_t n)
+{
+    if (n > SIZE_MAX / 2) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    const size_t need = CSTR_ARENA_ALIGN_ + cstr_arena_round_(n);
+    if ((size_t)(a->end - a->cur) < need && !cstr_arena_grow_(a, need)) {
+        return NULL;
+    }
+    char* p = a->cur + CSTR_ARENA_ALIGN_;
+    *cstr_arena_header_(p) = n;
+    a->cur  = a->cur + need;
+    a->last = p;
+    return p;
+}
+
+static void* cstr_arena_calloc_(size_t nmemb, size_t size)
+{
+    size_t n;
+    if (__builtin_mul_overflow(nmemb, size, &n)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    void* p = cstr_arena_alloc_((cstr_arena*)cstr_scope_ctx(), n);
+    if (p) {
+        memset(p, 0, n);
+    }
+    return p;
+}
+
+static void* cstr_arena_reallocarray_(void* p, size_t nmemb, size_t size)
+{
+    cstr_arena* a = (cstr_arena*)cstr_scope_ctx();
+    size_t n;
+    if (__builtin_mul_overflow(nmemb, size, &n)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (!p) {
+        return cstr_arena_alloc_(a, n);
+    }
+    const size_t old = *cstr_arena_header_(p);
+    if (p == a->last && n <= (size_t)(a->end - (char*)p)) {
+        *cstr_arena_header_(p) = n;
+        a->cur = (char*)p + cstr_arena_round_(n);
+        return p;
+    }
+    if (n <= old) {
+        *cstr_arena_header_(p) = n;
+        return p;
+    }
+    void* pnew = cstr_arena_alloc_(a, n);
+    if (pnew) {
+        memcpy(pnew, p, old);
+    }
+    return pnew;
+}
+
+static void cstr_arena_free_(void* p, size_t size)
+{
+    cstr_arena* a = (cstr_arena*)cstr_scope_ctx();
+    if (p != NULL && p == a->last) {
+        a->cur  = (char*)p - CSTR_ARENA_ALIGN_;
+        a->last = NULL;
+    }
+}
+
+void cstr_arena_init(cstr_arena* a, size_t block_size)
+{
+    memset(a, 0, sizeof(*a));
+    a->block_size = cstr_arena_round_(block_size ? block_size : 4096);
+}
+
+void cstr_arena_reset(cstr_arena* a)
+{
+    if (!a->head) {
+        return;
+    }
+    while (a->head->prev) {
+        struct cstr_arena_block_t* prev = a->head->prev;
+        a->head->prev = prev->prev;
+        free(prev);
+    }
+    a->cur  = (char*)(a->head + 1);
+    a->end  = a->cur + a->head->size;
+    a->last = NULL;
+}
+
+void cstr_arena_release(cstr_arena* a)
+{
+    while (a->head) {
+        struct cstr_arena_block_t* prev = a->head->prev;
+        free(a->head);
+        a->head = prev;
+    }
+    a->cur  = NULL;
+    a->end  = NULL;
+    a->last = NULL;
+}
+
+void cstr_arena_begin(cstr_arena* a)
+{
+    cstr_scope_begin(&a->scope, cstr_arena_allocator(), a);
+}
+
+void cstr_arena_end(cstr_arena* a)
+{
+    cstr_scope_end(&a->scope);
+}
+
+struct cstr_alloc_t cstr_arena_allocator(void)
+{
+    const struct cstr_alloc_t a = {
+        .calloc       = &cstr_arena_calloc_,
+        .reallocarray = &cstr_arena_reallocarray_,
+        .free         = &cstr_arena_free_,
+    };
+    return a;
+}
+
+//------------------------------------------------------------------------------
+// cstr layout
+//------------------------------------------------------------------------------
+#define CSTR_HEAP_BIT_ ((size_t)CSTR_HEAP_FLAG << (8 * (sizeof(size_t) - 1)))
+
+static unsigned char cstr_flag_(const cstr* s)
+{
+    return (unsigned char)s->data[CSTR_INLINE_SIZE];
+}
+
+// all ones for an out of line string, all zeroes for an inline one
+static size_t cstr_heap_mask_(const cstr* s)
+{
+    return -(size_t)(cstr_flag_(s) >> 7);
+}
+
+static void cstr_set_inline_size_(cstr* s, size_t size)
+{
+    assert(size <= CSTR_INLINE_SIZE);
+    s->data[size] = '\0';
+    s->data[CSTR_INLINE_SIZE] = (char)(CSTR_INLINE_SIZE - size);
+}
+
+static void cstr_set_heap_(cstr* s, char* data, size_t size, size_t capacity)
+{
+    assert((capacity & CSTR_HEAP_BIT_) == 0);
+    s->o.data     = data;
+    s->o.size     = size;
+    s->o.capacity = capacity | CSTR_HEAP_BIT_;
+}
+
+// Inline strings are kept zeroed past their end, so two of them can be
+// compared as whole objects. Only shrinking leaves stale chars behind.
+static void cstr_clear_tail_(cstr* s, size_t newsize, size_t oldsize)
+{
+    char* data = cstr_mstr(s);
+    if (cstr_isinline_(s)) {
+        memset(&data[newsize], '\0', oldsize - newsize);
+    } else {
+        data[newsize] = '\0';
+    }
+}
+
+static void cstr_set_size_(cstr* s, size_t size)
+{
+    if (cstr_isinline_(s)) {
+        cstr_set_inline_size_(s, size);
+    } else {
+        s->o.size = size;
+    }
+}
+
 //------------------------------------------------------------------------------
 // cstrview
 //------------------------------------------------------------------------------
@@ -226,15 +446,14 @@ cstrview cstrview_substr(cstrview v, size_t pos, size_t len)
 
 cstrview cstrview_split(const cstrview v, const char c)
 {
-    const char* p = (const char*)memchr(cstrview_data(v), c, cstrview_len(v));
+    const char* p = cstr_memchr_(cstrview_data(v), cstrview_len(v), c);
     return cstrview_fromrange(cstrview_data(v), p ? p : cstrview_end(v));
 }
 
 cstrview cstrview_split_on(cstrview v, cstrview v2)
 {
-    // TODO: Do I need to provide a backup implementation of memmem()?
-    const char* p = (const char*)memmem(cstrview_data(v), cstrview_len(v),
-                                        cstrview_data(v2), cstrview_len(v2));
+    const char* p = cstr_memmem_(cstrview_data(v), cstrview_len(v),
+                                 cstrview_data(v2), cstrview_len(v2));
     return cstrview_fromrange(cstrview_data(v), p ? p : cstrview_end(v));
 }
 
@@ -243,7 +462,7 @@ int cstrview_startswith(cstrview v, cstrview prefix)
     size_t len1 = cstrview_len(v);
     size_t len2 = cstrview_len(prefix);
     return len2 <= len1
-        && memcmp(cstrview_data(v), cstrview_data(prefix), len2) == 0;
+        && cstr_memcmp_(cstrview_data(v), cstrview_data(prefix), len2) == 0;
 }
 
 int cstrview_endswith(cstrview v, cstrview postfix)
@@ -252,7 +471,7 @@ int cstrview_endswith(cstrview v, cstrview postfix)
     size_t len2 = cstrview_len(postfix);
     size_t pos = len1 - len2;
     return len2 <= len1
-        && memcmp(cstrview_data(v) + pos, cstrview_data(postfix), len2) == 0;
+        && cstr_memcmp_(cstrview_data(v) + pos, cstrview_data(postfix), len2) == 0;
 }
 
 int cstrview_cmp(cstrview v1, cstrview v2)
@@ -260,19 +479,20 @@ int cstrview_cmp(cstrview v1, cstrview v2)
     size_t len1 = cstrview_len(v1);
     size_t len2 = cstrview_len(v2);
     size_t min_ = len1 < len2 ? len1 : len2;
-    int r = memcmp(cstrview_data(v1), cstrview_data(v2), min_);
-    // TODO: need to protect against len1 or len2 being longer than int
-    return r != 0 ? r : (int)len1 - (int)len2;
+    int r = cstr_memcmp_(cstrview_data(v1), cstrview_data(v2), min_);
+    return r != 0 ? r : (len1 > len2) - (len1 < len2);
 }
 
 int cstrview_eq(const cstrview v1, const cstrview v2)
 {
-    return cstrview_cmp(v1, v2) == 0;
+    const size_t len = cstrview_len(v1);
+    return len == cstrview_len(v2)
+        && cstr_memcmp_(cstrview_data(v1), cstrview_data(v2), len) == 0;
 }
 
 int cstrview_neq(const cstrview v1, const cstrview v2)
 {
-    return cstrview_cmp(v1, v2) != 0;
+    return !cstrview_eq(v1, v2);
 }
 
 int cstrview_gt(const cstrview v1, const cstrview v2)
@@ -333,7 +553,7 @@ cstr* cstr_new(const char* const s, const size_t len)
         return NULL;
     }
     if (!cstr_init(str, s, len)) {
-        free(str);
+        free_(str, sizeof(*str));
         return NULL;
     }
     return str;
@@ -359,7 +579,7 @@ cstr cstr_make2(const char* const s)
 void cstr_destroy(cstr* s)
 {
     if (!cstr_isinline_(s)) {
-        free_(s->o.data, s->o.capacity + 1);
+        free_(s->o.data, cstr_capacity(s) + 1);
 #ifndef NDEBUG
         s->o.data = NULL;
 #endif
@@ -376,17 +596,16 @@ cstr* cstr_init(cstr* str, const char* const s, size_t len)
         //       but not sure what codegen I get
         memset(&str->data[0], '\0', sizeof(str->data));
         memcpy(&str->data[0], s, len);
+        cstr_set_inline_size_(str, len);
     } else {                          // out of line:
-        str->o.data = (char*)calloc_(len + 1, sizeof(*str->o.data));
-        if (!str->o.data) {
+        char* data = (char*)calloc_(len + 1, sizeof(*data));
+        if (!data) {
             return NULL;
         }
-        memcpy(str->o.data, s, sizeof(*s) * len);
-        str->o.data[len] = '\0';
-        str->o.capacity = len;
-        str->data[CSTR_INLINE_SIZE] = 1;
+        memcpy(data, s, sizeof(*s) * len);
+        data[len] = '\0';
+        cstr_set_heap_(str, data, len, len);
     }
-    str->size = len;
     return str;
 }
 
@@ -398,23 +617,46 @@ void cstr_del(cstr* s)
     }
 }
 
-void cstr_set_allocator(struct cstr_alloc_t a)
+static struct cstr_alloc_t cstr_fill_allocator_(struct cstr_alloc_t a)
 {
-    cstr_allocator_ = a;
-
     if (a.calloc == NULL && a.reallocarray != NULL) {
-        cstr_allocator_.calloc = &calloc_using_reallocarray_;
+        a.calloc = &calloc_using_reallocarray_;
     }
 
 #if 0
     if (a.reallocarray == NULL && a.calloc != NULL) {
-        cstr_allocator_.reallocarray = &reallocarray_using_calloc_;
+        a.reallocarray = &reallocarray_using_calloc_;
     }
 #endif
 
-    assert(cstr_allocator_.calloc       != NULL);
-    assert(cstr_allocator_.reallocarray != NULL);
-    assert(cstr_allocator_.free         != NULL);
+    assert(a.calloc       != NULL);
+    assert(a.reallocarray != NULL);
+    assert(a.free         != NULL);
+    return a;
+}
+
+void cstr_set_allocator(struct cstr_alloc_t a)
+{
+    cstr_allocator_ = cstr_fill_allocator_(a);
+}
+
+void cstr_scope_begin(cstr_scope* scope, struct cstr_alloc_t a, void* ctx)
+{
+    scope->alloc = cstr_fill_allocator_(a);
+    scope->ctx   = ctx;
+    scope->prev  = cstr_scope_;
+    cstr_scope_  = scope;
+}
+
+void cstr_scope_end(cstr_scope* scope)
+{
+    assert(cstr_scope_ == scope && "scopes must end in reverse order");
+    cstr_scope_ = scope->prev;
+}
+
+void* cstr_scope_ctx(void)
+{
+    return cstr_scope_ ? cstr_scope_->ctx : NULL;
 }
 
 void cstr_reset_allocator_to_default_()
@@ -422,9 +664,12 @@ void cstr_reset_allocator_to_default_()
     cstr_allocator_ = malloc_allocator_;
 }
 
+// Branchless: the inline size and the heap size are both computed and one is
+// picked with the mask made from the flag bit.
 size_t cstr_size(const cstr* s)
 {
-    return s->size;
+    const size_t heap = cstr_heap_mask_(s);
+    return (s->o.size & heap) | (((size_t)CSTR_INLINE_SIZE - cstr_flag_(s)) & ~heap);
 }
 
 size_t cstr_len(const cstr* s)
@@ -450,19 +695,18 @@ bool cstr_is_empty(const cstr* s)
 size_t cstr_capacity(const cstr* s)
 {
     return cstr_isinline_(s) != 0 ?
-        CSTR_INLINE_SIZE : s->o.capacity;
+        CSTR_INLINE_SIZE : s->o.capacity & ~CSTR_HEAP_BIT_;
 }
 
 const char* cstr_str(const cstr* s)
 {
-    return cstr_isinline_(s) != 0 ?
-        s->data : s->o.data;
+    const uintptr_t heap = cstr_heap_mask_(s);
+    return (const char*)(((uintptr_t)s->o.data & heap) | ((uintptr_t)s->data & ~heap));
 }
 
 char* cstr_mstr(cstr* s)
 {
-    return cstr_isinline_(s) != 0 ?
-        s->data : s->o.data;
+    return (char*)cstr_str(s);
 }
 
 char* cstr_data(cstr* s)
@@ -472,7 +716,7 @@ char* cstr_data(cstr* s)
 
 int cstr_isinline_(const cstr* s)
 {
-    return s->data[CSTR_INLINE_SIZE] == '\0';
+    return (cstr_flag_(s) & CSTR_HEAP_FLAG) == 0;
 }
 
 char* cstr_inline_mark_(cstr* s)
@@ -487,12 +731,37 @@ size_t cstr_max_inline_size()
 
 int cstr_cmp(const cstr* s1, const cstr* s2)
 {
+    if (cstr_isinline_(s1) && cstr_isinline_(s2)) {
+        // big-endian word compares find the first differing char; past the
+        // end of the shorter string it has zeroes, so only the flag byte
+        // has to be masked off and ties broken by length
+        for (size_t i = 0; i != sizeof(s1->data); i += 8) {
+            uint64_t a, b;
+            memcpy(&a, &s1->data[i], 8);
+            memcpy(&b, &s2->data[i], 8);
+            a = __builtin_bswap64(a);
+            b = __builtin_bswap64(b);
+            if (i + 8 == sizeof(s1->data)) {
+                a &= ~(uint64_t)0xff;
+                b &= ~(uint64_t)0xff;
+            }
+            if (a != b) {
+                return a < b ? -1 : 1;
+            }
+        }
+        return (cstr_flag_(s1) < cstr_flag_(s2)) - (cstr_flag_(s1) > cstr_flag_(s2));
+    }
     return strcmp(cstr_str(s1), cstr_str(s2));
 }
 
 int cstr_eq(const cstr* s1, const cstr* s2)
 {
-    return cstr_cmp(s1, s2) == 0;
+    if (cstr_isinline_(s1) && cstr_isinline_(s2)) {
+        // the flag byte holds the size and the rest is zero past the end
+        return memcmp(s1->data, s2->data, sizeof(s1->data)) == 0;
+    }
+    const size_t len = cstr_len(s1);
+    return len == cstr_len(s2) && cstr_memcmp_(cstr_str(s1), cstr_str(s2), len) == 0;
 }
 
 int cstr_neq(const cstr* s1, const cstr* s2)
@@ -545,33 +814,56 @@ cstr* cstr_copy(const cstr* s)
     return cstr_new(cstr_str(s), cstr_size(s));
 }
 
-cstr* cstr_shink_to_fit(cstr* s)
+cstr* cstr_shrink_to_fit(cstr* s)
 {
     if (cstr_isinline_(s)) {
         return s;
     }
 
     const size_t size = cstr_size(s);
+    const size_t capacity = cstr_capacity(s);
     if (size <= CSTR_INLINE_SIZE) {
-        char*  str = s->o.data;
-        size_t cap = s->o.capacity;
+        char* str = s->o.data;
         memset(&s->data[0], '\0', CSTR_INLINE_SIZE + 1);
         memcpy(&s->data[0], str, size);
-        free_(str, s->o.capacity + 1);
+        cstr_set_inline_size_(s, size);
+        free_(str, capacity + 1);
         return s;
     }
 
-    const size_t capacity = cstr_capacity(s);
     if (capacity > size) {
         char* p = (char*)reallocarray_(s->o.data, size + 1, sizeof(char));
         if (p != NULL) {
-            s->o.data = p;
-            s->o.capacity = size;
+            cstr_set_heap_(s, p, size, size);
         }
     }
     return s;
 }
 
+cstr* cstr_reserve(cstr* s, size_t capacity)
+{
+    if (capacity <= cstr_capacity(s)) {
+        return s;
+    }
+    const size_t size = cstr_size(s);
+    char* data;
+    if (cstr_isinline_(s)) {
+        data = (char*)calloc_(capacity + 1, sizeof(char));
+        if (!data) {
+            return NULL;
+        }
+        memcpy(data, &s->data[0], size);
+    } else {
+        data = (char*)reallocarray_(s->o.data, capacity + 1, sizeof(char));
+        if (!data) {
+            return NULL;
+        }
+    }
+    data[size] = '\0';
+    cstr_set_heap_(s, data, size, capacity);
+    return s;
+}
+
 cstr* cstr_appendv(cstr* s, const cstrview v)
 {
     // NOTE: sizes and capacities don't include the NULL terminator
@@ -600,11 +892,10 @@ cstr* cstr_appendv(cstr* s, const cstrview v)
         }
         memcpy(&data[cursize], cstrview_data(v), addsize);
         data[newsize] = '\0';
-        s->o.data     = data;
-        s->o.capacity = newsize;
-        *cstr_inline_mark_(s) = 1;
+        cstr_set_heap_(s, data, newsize, newsize);
+        return s;
     }
-    s->size = newsize;
+    cstr_set_size_(s, newsize);
     return s;
 }
 
@@ -640,11 +931,10 @@ cstr* cstr_prependv(cstr* s, cstrview v)
         }
         memcpy(&data[0], cstrview_data(v), addsize);
         data[newsize] = '\0';
-        s->o.data = data;
-        s->o.capacity = newsize;
-        *cstr_inline_mark_(s) = 1;
+        cstr_set_heap_(s, data, newsize, newsize);
+        return s;
     }
-    s->size = newsize;
+    cstr_set_size_(s, newsize);
     return s;
 }
 
@@ -687,11 +977,10 @@ cstr* cstr_insertv(cstr* s, const size_t pos, cstrview v)
         }
         memcpy(&data[pos], cstrview_data(v), addsize);
         data[newsize] = '\0';
-        s->o.data = data;
-        s->o.capacity = newsize + 1;
-        *cstr_inline_mark_(s) = 1;
+        cstr_set_heap_(s, data, newsize, newsize);
+        return s;
     }
-    s->size = newsize;
+    cstr_set_size_(s, newsize);
     return s;
 }
 
@@ -704,9 +993,8 @@ cstr* cstr_take(cstr* s, size_t n)
 {
     const size_t oldsize = cstr_size(s);
     const size_t newsize = n < oldsize ? n : oldsize;
-    char* data = cstr_data(s);
-    data[newsize] = '\0';
-    s->size = newsize;
+    cstr_clear_tail_(s, newsize, oldsize);
+    cstr_set_size_(s, newsize);
     return s;
 }
 
@@ -717,8 +1005,8 @@ cstr* cstr_drop(cstr* s, size_t n)
     const size_t newsize = oldsize - n;
     char* data = cstr_data(s);
     memmove(&data[0], &data[n], newsize);
-    data[newsize] = '\0';
-    s->size = newsize;
+    cstr_clear_tail_(s, newsize, oldsize);
+    cstr_set_size_(s, newsize);
     return s;
 }
 
@@ -9,7 +9,8 @@
 extern "C" {
 #endif
 
-#define CSTR_INLINE_SIZE 19
+#define CSTR_INLINE_SIZE 23
+#define CSTR_HEAP_FLAG   0x80
 
 #define CSTR_STATIC_ASSERT_(COND, MSG) \
     typedef char static_assertion_##MSG[(!!(COND)) * 2 - 1]
@@ -17,19 +18,40 @@ extern "C" {
 #define CSTR_COMPILE_TIME_ASSERT2_(X, L) CSTR_COMPILE_TIME_ASSERT3_(X, L)
 #define CSTR_STATIC_ASSERT(X) CSTR_COMPILE_TIME_ASSERT2_(X, __LINE__)
 
+#if __BYTE_ORDER__ != __ORDER_LITTLE_ENDIAN__
+#error "cstr keeps its flag byte in the top byte of o.capacity: little endian only"
+#endif
+
+// Strings of up to CSTR_INLINE_SIZE chars are stored inline, in all but the
+// last byte. The last byte says which form the string is in: inline it holds
+// CSTR_INLINE_SIZE - size, so it doubles as the NUL terminator of a full
+// inline string; out of line it is the top byte of o.capacity, with
+// CSTR_HEAP_FLAG set. Inline strings are zero past their end, so equal
+// inline strings are equal objects.
+//
+// That makes the all-zero cstr a full inline string, not an empty one: start
+// from CSTR_EMPTY (C) or the default constructor (C++), or use cstr_init().
 struct cstr_t
 {
-    uint32_t size;
     union {
         struct {
             char*  data;
-            size_t capacity;
+            size_t size;
+            size_t capacity; // top byte is the flag byte
         } o;
         char data[CSTR_INLINE_SIZE + 1];
-    } __attribute__((packed));
+    };
+#ifdef __cplusplus
+    cstr_t() noexcept : data{} { data[CSTR_INLINE_SIZE] = CSTR_INLINE_SIZE; }
+#endif
 };
 typedef struct cstr_t cstr;
-CSTR_STATIC_ASSERT(sizeof(cstr) == (4 + CSTR_INLINE_SIZE + 1));
+CSTR_STATIC_ASSERT(sizeof(cstr) == (CSTR_INLINE_SIZE + 1));
+CSTR_STATIC_ASSERT(sizeof(cstr) == 3*sizeof(size_t));
+
+#ifndef __cplusplus
+#define CSTR_EMPTY ((cstr){ .data = { [CSTR_INLINE_SIZE] = CSTR_INLINE_SIZE } })
+#endif
 
 struct cstrview_t
 {
@@ -46,6 +68,36 @@ struct cstr_alloc_t
     void  (*free        )(void* p, size_t size);
 };
 
+// cstr_set_allocator() sets the allocator for every thread. A scope binds
+// another allocator, and a context pointer for it, to the calling thread
+// until cstr_scope_end(); scopes nest. cstr has no room to remember its
+// allocator, so a string must only be grown or destroyed under the allocator
+// it was allocated with.
+struct cstr_scope_t
+{
+    struct cstr_alloc_t  alloc;
+    void*                ctx;
+    struct cstr_scope_t* prev;
+};
+typedef struct cstr_scope_t cstr_scope;
+
+// Bump allocator for strings that are built and then all discarded together:
+// while an arena is bound, strings don't need destroying, cstr_arena_reset()
+// or cstr_arena_release() frees them at once. Freeing only gives back the
+// most recent allocation, and reallocating the most recent one grows it in
+// place, so appending to the last string built doesn't copy.
+struct cstr_arena_block_t;
+struct cstr_arena_t
+{
+    struct cstr_arena_block_t* head;
+    char*      cur;
+    char*      end;
+    char*      last;       // most recent allocation
+    size_t     block_size;
+    cstr_scope scope;
+};
+typedef struct cstr_arena_t cstr_arena;
+
 //------------------------------------------------------------------------------
 // cstrview
 //------------------------------------------------------------------------------
@@ -113,6 +165,20 @@ void  cstr_destroy(cstr* s);
 cstr* cstr_init(cstr* str, const char* s, size_t len);
 void  cstr_set_allocator(struct cstr_alloc_t a);
 
+// Allocator Scopes:
+void  cstr_scope_begin(cstr_scope* scope, struct cstr_alloc_t a, void* ctx);
+void  cstr_scope_end(cstr_scope* scope);
+void* cstr_scope_ctx(void); // ctx of the innermost scope, NULL outside one
+
+// Arena:
+void cstr_arena_init(cstr_arena* a, size_t block_size);
+void cstr_arena_reset(cstr_arena* a);   // frees all strings, keeps a block
+void cstr_arena_release(cstr_arena* a); // frees all strings and blocks
+void cstr_arena_begin(cstr_arena* a);   // allocate from `a` on this thread
+void cstr_arena_end(cstr_arena* a);
+// allocates from the arena that is cstr_scope_ctx()
+struct cstr_alloc_t cstr_arena_allocator(void);
+
 // Length / Capacity Accessors:
 size_t cstr_size(const cstr* s);
 size_t cstr_len(const cstr* s);
@@ -143,6 +209,7 @@ int cstr_endswith(const cstr* s1, const cstr* s2);
 // Mutators:
 cstr* cstr_copy(const cstr* s);
 cstr* cstr_shrink_to_fit(cstr* s);
+cstr* cstr_reserve(cstr* s, size_t capacity); // capacity for chars, as cstr_capacity()
 cstr* cstr_appendv(cstr* s, cstrview v);
 cstr* cstr_append(cstr* s, const cstr* s2);
 cstr* cstr_prependv(cstr* s, cstrview v);
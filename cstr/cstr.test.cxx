@@ -1,6 +1,8 @@
 #include <catch2/catch.hpp>
 #include <cstr.h>
 #include <string>
+#include <string_view>
+#include <algorithm>
 #include <cstring>
 #include <vector>
 
@@ -58,6 +60,11 @@ TEST_CASE("String comparisons")
         "9998",
         "99998",
         "0123456789",
+        "The quick brown fox ",
+        "The quick brown fox ju",
+        "The quick brown fox jum",
+        "The quick brown fox jun",
+        "The quick brown fox jumps",
     };
 
     auto normalize = [](int r) -> int
@@ -184,6 +191,8 @@ TEST_CASE("SSO")
     std::vector<std::string> cases = {
         "",
         "1234567890123456789",
+        "12345678901234567890",
+        "12345678901234567890123",
         "asdf asdf FFF\00189",
         "Hello, World",
         "Bye Bye",
@@ -202,6 +211,41 @@ TEST_CASE("SSO")
     cstr_reset_allocator_to_default_();
 }
 
+TEST_CASE("Up to 23 chars are inline and NUL terminated")
+{
+    cstr empty{};
+    CHECK(cstr_isinline_(&empty));
+    CHECK(cstr_len(&empty) == 0);
+    CHECK(cstr_capacity(&empty) == 23);
+    CHECK(cstr_str(&empty)[0] == '\0');
+
+    cstr s = cstr_make("", 0);
+    std::string expect;
+    for (char c = 'a'; c < 'a' + 23; ++c) {
+        const char buf[1] = { c };
+        expect += c;
+        cstr_appendv(&s, cstrview_init(buf, 1));
+        REQUIRE(cstr_isinline_(&s));
+        CHECK(cstr_len(&s) == expect.size());
+        CHECK(strlen(cstr_str(&s)) == expect.size());
+        CHECK(to_string(&s) == expect);
+    }
+
+    cstr_appendv(&s, cstrview_make("x"));
+    expect += 'x';
+    CHECK(!cstr_isinline_(&s));
+    CHECK(cstr_len(&s) == 24);
+    CHECK(cstr_capacity(&s) >= 24);
+    CHECK(to_string(&s) == expect);
+
+    cstr_take(&s, 23);
+    cstr_shrink_to_fit(&s);
+    CHECK(cstr_isinline_(&s));
+    CHECK(cstr_len(&s) == 23);
+    CHECK(to_string(&s) == expect.substr(0, 23));
+    cstr_destroy(&s);
+}
+
 TEST_CASE("Append")
 {
     std::vector<std::string> cases = {
@@ -635,6 +679,141 @@ TEST_CASE("Allocator fallbacks")
 #endif
 }
 
+TEST_CASE("Allocator scopes")
+{
+    static int ncalls = 0;
+    auto* counting_calloc = +[](size_t nmemb, size_t size) -> void*
+    {
+        ++ncalls;
+        return calloc(nmemb, size);
+    };
+    auto* counting_free = +[](void* p, size_t) -> void
+    {
+        ++ncalls;
+        free(p);
+    };
+    const std::string a = "This is a very long string that won't fit in SSO";
+
+    cstr_scope outer;
+    cstr_scope_begin(&outer, cstr_alloc_t{ counting_calloc, &reallocarray, counting_free }, &ncalls);
+    CHECK(cstr_scope_ctx() == &ncalls);
+    {
+        cstr s = cstr_make(a.c_str(), a.size());
+        CHECK(ncalls == 1);
+
+        cstr_arena arena;
+        cstr_arena_init(&arena, 0);
+        cstr_arena_begin(&arena);
+        CHECK(cstr_scope_ctx() == &arena);
+        cstr t = cstr_make(a.c_str(), a.size());
+        CHECK(to_string(&t) == a);
+        cstr_arena_end(&arena);
+        cstr_arena_release(&arena);
+        CHECK(ncalls == 1);
+
+        cstr_destroy(&s);
+        CHECK(ncalls == 2);
+    }
+    cstr_scope_end(&outer);
+    CHECK(cstr_scope_ctx() == nullptr);
+}
+
+TEST_CASE("Arena")
+{
+    const std::string a = "This is a very long string that won't fit in SSO";
+    cstr_arena arena;
+    cstr_arena_init(&arena, 256);
+
+    SECTION("Strings are allocated from the arena")
+    {
+        cstr_arena_begin(&arena);
+        std::vector<cstr> strs;
+        for (int i = 0; i < 100; ++i) {
+            strs.push_back(cstr_make(a.c_str(), a.size()));
+        }
+        for (auto& s : strs) {
+            CHECK(to_string(&s) == a);
+        }
+        cstr_arena_end(&arena);
+    }
+
+    SECTION("Appending to the last string grows it in place")
+    {
+        cstr_arena_begin(&arena);
+        cstr other = cstr_make(a.c_str(), a.size());
+        cstr s     = cstr_make(a.c_str(), a.size());
+        const char* data = cstr_str(&s);
+        cstr_appendv(&s, cstrview_init("!!!", 3));
+        CHECK(cstr_str(&s) == data);
+        CHECK(to_string(&s) == a + "!!!");
+
+        // not the last allocation any more: copied
+        cstr_append(&other, &s);
+        CHECK(to_string(&other) == a + a + "!!!");
+        CHECK(to_string(&s) == a + "!!!");
+        cstr_arena_end(&arena);
+    }
+
+    SECTION("Destroying the last string gives its memory back")
+    {
+        cstr_arena_begin(&arena);
+        cstr s = cstr_make(a.c_str(), a.size());
+        const char* data = cstr_str(&s);
+        cstr_destroy(&s);
+        cstr t = cstr_make(a.c_str(), a.size());
+        CHECK(cstr_str(&t) == data);
+        cstr_arena_end(&arena);
+    }
+
+    SECTION("Strings bigger than a block")
+    {
+        const std::string big(1000, 'x');
+        cstr_arena_begin(&arena);
+        cstr s = cstr_make(a.c_str(), a.size());
+        cstr t = cstr_make(big.c_str(), big.size());
+        cstr_append(&s, &t);
+        CHECK(to_string(&s) == a + big);
+        CHECK(to_string(&t) == big);
+        cstr_arena_end(&arena);
+    }
+
+    SECTION("Reset reuses the memory")
+    {
+        cstr_arena_begin(&arena);
+        cstr s = cstr_make(a.c_str(), a.size());
+        const char* data = cstr_str(&s);
+        cstr_make(a.c_str(), a.size());
+        cstr_make(a.c_str(), a.size());
+        cstr_arena_reset(&arena);
+        cstr t = cstr_make(a.c_str(), a.size());
+        CHECK(cstr_str(&t) == data);
+        CHECK(to_string(&t) == a);
+        cstr_arena_end(&arena);
+    }
+
+    cstr_arena_release(&arena);
+}
+
+TEST_CASE("Reserve")
+{
+    const std::string a = "Hello";
+    const std::string b = "This is a very long string that won't fit in SSO";
+    cstr s = cstr_make(a.c_str(), a.size());
+    REQUIRE(cstr_reserve(&s, 10) == &s);
+    CHECK(cstr_isinline_(&s));
+
+    REQUIRE(cstr_reserve(&s, 200) == &s);
+    CHECK(!cstr_isinline_(&s));
+    CHECK(cstr_capacity(&s) == 200);
+    CHECK(to_string(&s) == a);
+
+    const char* data = cstr_str(&s);
+    cstr_appendv(&s, cstrview_init(b.c_str(), b.size()));
+    CHECK(cstr_str(&s) == data);
+    CHECK(to_string(&s) == a + b);
+    cstr_destroy(&s);
+}
+
 TEST_CASE("Substr")
 {
     SECTION("SSO")
@@ -921,6 +1100,46 @@ template <> cstr make<cstr>(const char* const s)
     return cstr_make(s, strlen(s));
 }
 
+TEST_CASE("Search and compare across vector boundaries")
+{
+    // lengths on both sides of the 32 and 64 byte blocks, with the match at
+    // every position, including the overlapping last block
+    std::string text;
+    for (int i = 0; i < 200; ++i) {
+        text.push_back(static_cast<char>('a' + i % 7));
+    }
+
+    for (std::size_t len = 0; len <= text.size(); ++len) {
+        for (std::size_t pos = 0; pos <= len; ++pos) {
+            INFO("len=" << len << " pos=" << pos);
+            std::string s = text.substr(0, len);
+            if (pos < len) {
+                s[pos] = ',';
+            }
+            const std::string_view sv = s;
+            cstrview v = cstrview_init(s.data(), s.size());
+
+            CHECK(cstrview_len(cstrview_split(v, ',')) == std::min(sv.find(','), len));
+
+            if (pos + 3 <= len) {
+                s[pos + 2] = ';';
+                const std::string needle = s.substr(pos, 3);
+                cstrview r = cstrview_split_on(v, cstrview_init(needle.data(), needle.size()));
+                CHECK(cstrview_len(r) == std::min(sv.find(needle), len));
+            }
+
+            std::string t = s;
+            if (pos < len) {
+                t[pos] = '\xff';
+            }
+            cstrview w = cstrview_init(t.data(), t.size());
+            CHECK((cstrview_cmp(v, w) < 0) == (sv.compare(t) < 0));
+            CHECK(cstrview_eq(v, w) == (pos == len));
+            CHECK(cstrview_startswith(w, v) == (pos == len));
+        }
+    }
+}
+
 TEST_CASE("Verify BM_AppendSmallStrings")
 {
     auto expect = []() {
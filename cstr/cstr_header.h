@@ -7,23 +7,34 @@
 #include <assert.h>
 #include <errno.h>
 #include <malloc.h>
+#include "cstr_simd.h"
 
 #define CSTR_FORCE_INLINE [[gnu::always_inline]] inline
 
-#define CSTR_INLINE_SIZE 19
+#define CSTR_INLINE_SIZE 23
+#define CSTR_HEAP_FLAG   0x80
+#define CSTR_HEAP_BIT_   ((size_t)CSTR_HEAP_FLAG << (8 * (sizeof(size_t) - 1)))
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+
+// Same layout as cstr.h: the last byte is CSTR_INLINE_SIZE - size for inline
+// strings (the NUL terminator of a full one), or the top byte of o.capacity
+// with CSTR_HEAP_FLAG set.
 struct cstr_t
 {
-    uint32_t size = 0;
     union {
         struct {
             char*  data;
-            size_t capacity;
+            size_t size;
+            size_t capacity; // top byte is the flag byte
         } o;
-        char data[CSTR_INLINE_SIZE + 1] = { 0 };
-    } __attribute__((packed));
+        char data[CSTR_INLINE_SIZE + 1];
+    };
+
+    cstr_t() noexcept : data{} { data[CSTR_INLINE_SIZE] = CSTR_INLINE_SIZE; }
 };
 typedef struct cstr_t cstr;
-static_assert(sizeof(cstr) == (4 + CSTR_INLINE_SIZE + 1));
+static_assert(sizeof(cstr) == (CSTR_INLINE_SIZE + 1));
 
 struct cstrview_t
 {
@@ -33,15 +44,41 @@ struct cstrview_t
 typedef struct cstrview_t cstrview;
 static_assert(sizeof(cstrview) == 2*sizeof(void*));
 
-// put this back in later:
-#if 0
 struct cstr_alloc_t
 {
     void* (*calloc      )(size_t nmemb, size_t size);
     void* (*reallocarray)(void* p, size_t nmemb, size_t size);
     void  (*free        )(void* p, size_t size);
 };
-#endif
+
+// Same as cstr.h: a scope binds an allocator to this thread until
+// cstr_scope_end(), outside of any scope strings use malloc.
+struct cstr_scope_t
+{
+    cstr_alloc_t  alloc;
+    void*         ctx;
+    cstr_scope_t* prev;
+};
+typedef struct cstr_scope_t cstr_scope;
+
+struct cstr_arena_block_t
+{
+    cstr_arena_block_t* prev;
+    size_t              size;
+};
+
+struct cstr_arena_t
+{
+    cstr_arena_block_t* head;
+    char*      cur;
+    char*      end;
+    char*      last;       // most recent allocation
+    size_t     block_size;
+    cstr_scope scope;
+};
+typedef struct cstr_arena_t cstr_arena;
+
+inline thread_local cstr_scope* cstr_scope_ = nullptr;
 
 CSTR_FORCE_INLINE cstr     cstr_make(const char* s, size_t len) noexcept;
 CSTR_FORCE_INLINE cstr*    cstr_init(cstr* str, const char* s, size_t len) noexcept;
@@ -66,6 +103,8 @@ CSTR_FORCE_INLINE cstr* cstr_prepend(cstr* s, const cstr* s2) noexcept;
 CSTR_FORCE_INLINE char* cstr_data(cstr* s) noexcept;
 CSTR_FORCE_INLINE cstr* cstr_insertv(cstr* s, size_t pos, cstrview v) noexcept;
 CSTR_FORCE_INLINE cstr* cstr_insert(cstr* s, size_t pos, const cstr* s2) noexcept;
+CSTR_FORCE_INLINE int   cstr_cmp(const cstr* s1, const cstr* s2) noexcept;
+CSTR_FORCE_INLINE int   cstr_eq(const cstr* s1, const cstr* s2) noexcept;
 
 //------------------------------------------------------------------------------
 // Implementation
@@ -73,19 +112,229 @@ CSTR_FORCE_INLINE cstr* cstr_insert(cstr* s, size_t pos, const cstr* s2) noexcep
 
 CSTR_FORCE_INLINE void* calloc_(size_t nmemb, size_t size) noexcept
 {
+    if (cstr_scope_) {
+        return cstr_scope_->alloc.calloc(nmemb, size);
+    }
     return calloc(nmemb, size);
 }
 
 CSTR_FORCE_INLINE void* reallocarray_(void* p, size_t nmemb, size_t size) noexcept
 {
+    if (cstr_scope_) {
+        return cstr_scope_->alloc.reallocarray(p, nmemb, size);
+    }
     return reallocarray(p, nmemb, size);
 }
 
 CSTR_FORCE_INLINE void free_(void* p, size_t size) noexcept
 {
+    if (cstr_scope_) {
+        cstr_scope_->alloc.free(p, size);
+        return;
+    }
     free(p/*, size*/);
 }
 
+inline void cstr_scope_begin(cstr_scope* scope, cstr_alloc_t a, void* ctx) noexcept
+{
+    assert(a.calloc && a.reallocarray && a.free);
+    scope->alloc = a;
+    scope->ctx   = ctx;
+    scope->prev  = cstr_scope_;
+    cstr_scope_  = scope;
+}
+
+inline void cstr_scope_end(cstr_scope* scope) noexcept
+{
+    assert(cstr_scope_ == scope && "scopes must end in reverse order");
+    cstr_scope_ = scope->prev;
+}
+
+inline void* cstr_scope_ctx() noexcept
+{
+    return cstr_scope_ ? cstr_scope_->ctx : nullptr;
+}
+
+//------------------------------------------------------------------------------
+// cstr_arena, see cstr.c
+//------------------------------------------------------------------------------
+
+#define CSTR_ARENA_ALIGN_ sizeof(size_t)
+
+CSTR_FORCE_INLINE size_t cstr_arena_round_(size_t n) noexcept
+{
+    return (n + CSTR_ARENA_ALIGN_ - 1) & ~(CSTR_ARENA_ALIGN_ - 1);
+}
+
+CSTR_FORCE_INLINE size_t* cstr_arena_header_(void* p) noexcept
+{
+    return static_cast<size_t*>(p) - 1;
+}
+
+inline bool cstr_arena_grow_(cstr_arena* a, size_t need) noexcept
+{
+    const size_t size = need > a->block_size ? need : a->block_size;
+    auto* block = static_cast<cstr_arena_block_t*>(malloc(sizeof(cstr_arena_block_t) + size));
+    if (!block) {
+        return false;
+    }
+    block->prev = a->head;
+    block->size = size;
+    a->head = block;
+    a->cur  = reinterpret_cast<char*>(block + 1);
+    a->end  = a->cur + size;
+    return true;
+}
+
+inline void* cstr_arena_alloc_(cstr_arena* a, size_t n) noexcept
+{
+    if (n > SIZE_MAX / 2) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    const size_t need = CSTR_ARENA_ALIGN_ + cstr_arena_round_(n);
+    if (static_cast<size_t>(a->end - a->cur) < need && !cstr_arena_grow_(a, need)) {
+        return NULL;
+    }
+    char* p = a->cur + CSTR_ARENA_ALIGN_;
+    *cstr_arena_header_(p) = n;
+    a->cur  = a->cur + need;
+    a->last = p;
+    return p;
+}
+
+inline void* cstr_arena_calloc_(size_t nmemb, size_t size) noexcept
+{
+    size_t n;
+    if (__builtin_mul_overflow(nmemb, size, &n)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    void* p = cstr_arena_alloc_(static_cast<cstr_arena*>(cstr_scope_ctx()), n);
+    if (p) {
+        memset(p, 0, n);
+    }
+    return p;
+}
+
+inline void* cstr_arena_reallocarray_(void* p, size_t nmemb, size_t size) noexcept
+{
+    auto* a = static_cast<cstr_arena*>(cstr_scope_ctx());
+    size_t n;
+    if (__builtin_mul_overflow(nmemb, size, &n)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    if (!p) {
+        return cstr_arena_alloc_(a, n);
+    }
+    const size_t old = *cstr_arena_header_(p);
+    if (p == a->last && n <= static_cast<size_t>(a->end - static_cast<char*>(p))) {
+        *cstr_arena_header_(p) = n;
+        a->cur = static_cast<char*>(p) + cstr_arena_round_(n);
+        return p;
+    }
+    if (n <= old) {
+        *cstr_arena_header_(p) = n;
+        return p;
+    }
+    void* pnew = cstr_arena_alloc_(a, n);
+    if (pnew) {
+        memcpy(pnew, p, old);
+    }
+    return pnew;
+}
+
+inline void cstr_arena_free_(void* p, size_t) noexcept
+{
+    auto* a = static_cast<cstr_arena*>(cstr_scope_ctx());
+    if (p != NULL && p == a->last) {
+        a->cur  = static_cast<char*>(p) - CSTR_ARENA_ALIGN_;
+        a->last = NULL;
+    }
+}
+
+inline void cstr_arena_init(cstr_arena* a, size_t block_size) noexcept
+{
+    *a = cstr_arena{};
+    a->block_size = cstr_arena_round_(block_size ? block_size : 4096);
+}
+
+inline void cstr_arena_reset(cstr_arena* a) noexcept
+{
+    if (!a->head) {
+        return;
+    }
+    while (a->head->prev) {
+        cstr_arena_block_t* prev = a->head->prev;
+        a->head->prev = prev->prev;
+        free(prev);
+    }
+    a->cur  = reinterpret_cast<char*>(a->head + 1);
+    a->end  = a->cur + a->head->size;
+    a->last = NULL;
+}
+
+inline void cstr_arena_release(cstr_arena* a) noexcept
+{
+    while (a->head) {
+        cstr_arena_block_t* prev = a->head->prev;
+        free(a->head);
+        a->head = prev;
+    }
+    a->cur  = NULL;
+    a->end  = NULL;
+    a->last = NULL;
+}
+
+inline cstr_alloc_t cstr_arena_allocator() noexcept
+{
+    return cstr_alloc_t{ &cstr_arena_calloc_, &cstr_arena_reallocarray_, &cstr_arena_free_ };
+}
+
+inline void cstr_arena_begin(cstr_arena* a) noexcept
+{
+    cstr_scope_begin(&a->scope, cstr_arena_allocator(), a);
+}
+
+inline void cstr_arena_end(cstr_arena* a) noexcept
+{
+    cstr_scope_end(&a->scope);
+}
+
+CSTR_FORCE_INLINE unsigned char cstr_flag_(const cstr* s) noexcept
+{
+    return (unsigned char)s->data[CSTR_INLINE_SIZE];
+}
+
+// all ones for an out of line string, all zeroes for an inline one
+CSTR_FORCE_INLINE size_t cstr_heap_mask_(const cstr* s) noexcept
+{
+    return -(size_t)(cstr_flag_(s) >> 7);
+}
+
+CSTR_FORCE_INLINE void cstr_set_inline_size_(cstr* s, size_t size) noexcept
+{
+    s->data[size] = '\0';
+    s->data[CSTR_INLINE_SIZE] = (char)(CSTR_INLINE_SIZE - size);
+}
+
+CSTR_FORCE_INLINE void cstr_set_heap_(cstr* s, char* data, size_t size, size_t capacity) noexcept
+{
+    s->o.data     = data;
+    s->o.size     = size;
+    s->o.capacity = capacity | CSTR_HEAP_BIT_;
+}
+
+CSTR_FORCE_INLINE void cstr_set_size_(cstr* s, size_t size) noexcept
+{
+    if (cstr_isinline_(s)) {
+        cstr_set_inline_size_(s, size);
+    } else {
+        s->o.size = size;
+    }
+}
+
 cstrview cstr_view(const cstr* s) noexcept
 {
     return cstrview_init(cstr_str(s), cstr_len(s));
@@ -108,23 +357,31 @@ cstr* cstr_init(cstr* str, const char* const s, size_t len) noexcept
         //       but not sure what codegen I get
         memset(&str->data[0], '\0', sizeof(str->data));
         memcpy(&str->data[0], s, len);
+        cstr_set_inline_size_(str, len);
     } else {                          // out of line:
-        str->o.data = (char*)calloc_(len + 1, sizeof(*str->o.data));
-        if (!str->o.data) {
+        char* data = (char*)calloc_(len + 1, sizeof(*data));
+        if (!data) {
             return NULL;
         }
-        memcpy(str->o.data, s, sizeof(*s) * len);
-        str->o.data[len] = '\0';
-        str->o.capacity = len;
-        str->data[CSTR_INLINE_SIZE] = 1;
+        memcpy(data, s, sizeof(*s) * len);
+        data[len] = '\0';
+        cstr_set_heap_(str, data, len, len);
     }
-    str->size = len;
     return str;
 }
 
+inline void cstr_destroy(cstr* s) noexcept
+{
+    if (!cstr_isinline_(s)) {
+        free_(s->o.data, cstr_capacity(s) + 1);
+    }
+}
+
+// branchless: both sizes are computed and one is picked by the flag bit
 size_t cstr_len(const cstr* s) noexcept
 {
-    return s->size;
+    const size_t heap = cstr_heap_mask_(s);
+    return (s->o.size & heap) | (((size_t)CSTR_INLINE_SIZE - cstr_flag_(s)) & ~heap);
 }
 
 cstr* cstr_append(cstr* s, const cstr* s2) noexcept
@@ -168,11 +425,10 @@ cstr* cstr_appendv(cstr* s, const cstrview v) noexcept
         }
         memcpy(&data[cursize], cstrview_data(v), addsize);
         data[newsize] = '\0';
-        s->o.data     = data;
-        s->o.capacity = newsize;
-        *cstr_inline_mark_(s) = 1;
+        cstr_set_heap_(s, data, newsize, newsize);
+        return s;
     }
-    s->size = newsize;
+    cstr_set_size_(s, newsize);
     return s;
 }
 
@@ -184,12 +440,12 @@ size_t cstrview_len(const cstrview v) noexcept
 size_t cstr_capacity(const cstr* s) noexcept
 {
     return cstr_isinline_(s) != 0 ?
-        CSTR_INLINE_SIZE : s->o.capacity;
+        CSTR_INLINE_SIZE : s->o.capacity & ~CSTR_HEAP_BIT_;
 }
 
 int cstr_isinline_(const cstr* s) noexcept
 {
-    return s->data[CSTR_INLINE_SIZE] == '\0';
+    return (cstr_flag_(s) & CSTR_HEAP_FLAG) == 0;
 }
 
 char* cstr_inline_mark_(cstr* s) noexcept
@@ -204,8 +460,8 @@ const char* cstrview_data(cstrview v) noexcept
 
 const char* cstr_str(const cstr* s) noexcept
 {
-    return cstr_isinline_(s) != 0 ?
-        s->data : s->o.data;
+    const uintptr_t heap = cstr_heap_mask_(s);
+    return (const char*)(((uintptr_t)s->o.data & heap) | ((uintptr_t)s->data & ~heap));
 }
 
 cstr* cstr_prepend(cstr* s, const cstr* s2) noexcept
@@ -240,18 +496,16 @@ cstr* cstr_prependv(cstr* s, cstrview v) noexcept
         }
         memcpy(&data[0], cstrview_data(v), addsize);
         data[newsize] = '\0';
-        s->o.data = data;
-        s->o.capacity = newsize;
-        *cstr_inline_mark_(s) = 1;
+        cstr_set_heap_(s, data, newsize, newsize);
+        return s;
     }
-    s->size = newsize;
+    cstr_set_size_(s, newsize);
     return s;
 }
 
 char* cstr_data(cstr* s) noexcept
 {
-    return cstr_isinline_(s) != 0 ?
-        s->data : s->o.data;
+    return (char*)cstr_str(s);
 }
 
 cstr* cstr_insertv(cstr* s, const size_t pos, cstrview v) noexcept
@@ -289,11 +543,10 @@ cstr* cstr_insertv(cstr* s, const size_t pos, cstrview v) noexcept
         }
         memcpy(&data[pos], cstrview_data(v), addsize);
         data[newsize] = '\0';
-        s->o.data = data;
-        s->o.capacity = newcapacity;
-        *cstr_inline_mark_(s) = 1;
+        cstr_set_heap_(s, data, newsize, newcapacity);
+        return s;
     }
-    s->size = newsize;
+    cstr_set_size_(s, newsize);
     return s;
 }
 
@@ -301,3 +554,138 @@ cstr* cstr_insert(cstr* s, const size_t pos, const cstr* s2) noexcept
 {
     return cstr_insertv(s, pos, cstr_view(s2));
 }
+
+int cstr_cmp(const cstr* s1, const cstr* s2) noexcept
+{
+    if (cstr_isinline_(s1) && cstr_isinline_(s2)) {
+        // big-endian word compares find the first differing char; past the
+        // end of the shorter string it has zeroes, so only the flag byte
+        // has to be masked off and ties broken by length
+        for (size_t i = 0; i != sizeof(s1->data); i += 8) {
+            uint64_t a, b;
+            memcpy(&a, &s1->data[i], 8);
+            memcpy(&b, &s2->data[i], 8);
+            a = __builtin_bswap64(a);
+            b = __builtin_bswap64(b);
+            if (i + 8 == sizeof(s1->data)) {
+                a &= ~(uint64_t)0xff;
+                b &= ~(uint64_t)0xff;
+            }
+            if (a != b) {
+                return a < b ? -1 : 1;
+            }
+        }
+        return (cstr_flag_(s1) < cstr_flag_(s2)) - (cstr_flag_(s1) > cstr_flag_(s2));
+    }
+    const size_t len1 = cstr_len(s1);
+    const size_t len2 = cstr_len(s2);
+    const int r = memcmp(cstr_str(s1), cstr_str(s2), len1 < len2 ? len1 : len2);
+    return r != 0 ? r : (len1 > len2) - (len1 < len2);
+}
+
+int cstr_eq(const cstr* s1, const cstr* s2) noexcept
+{
+    if (cstr_isinline_(s1) && cstr_isinline_(s2)) {
+        // the flag byte holds the size and the rest is zero past the end
+        return memcmp(s1->data, s2->data, sizeof(s1->data)) == 0;
+    }
+    const size_t len = cstr_len(s1);
+    return len == cstr_len(s2) && cstr_memcmp_(cstr_str(s1), cstr_str(s2), len) == 0;
+}
+
+//------------------------------------------------------------------------------
+// cstrview search and comparison, see cstr.c
+//------------------------------------------------------------------------------
+
+inline const char* cstrview_end(cstrview v) noexcept
+{
+    return v.end;
+}
+
+inline bool cstrview_empty(cstrview v) noexcept
+{
+    return v.begin == v.end;
+}
+
+inline cstrview cstrview_fromrange(const char* begin, const char* end) noexcept
+{
+    cstrview v;
+    v.begin = begin;
+    v.end   = end;
+    return v;
+}
+
+inline cstrview cstrview_drop(cstrview v, size_t n) noexcept
+{
+    const size_t size = cstrview_len(v);
+    v.begin += n < size ? n : size;
+    return v;
+}
+
+inline cstrview cstrview_split(cstrview v, char c) noexcept
+{
+    const char* p = cstr_memchr_(cstrview_data(v), cstrview_len(v), c);
+    return cstrview_fromrange(cstrview_data(v), p ? p : cstrview_end(v));
+}
+
+inline cstrview cstrview_split_on(cstrview v, cstrview v2) noexcept
+{
+    const char* p = cstr_memmem_(cstrview_data(v), cstrview_len(v),
+                                 cstrview_data(v2), cstrview_len(v2));
+    return cstrview_fromrange(cstrview_data(v), p ? p : cstrview_end(v));
+}
+
+inline int cstrview_startswith(cstrview v, cstrview prefix) noexcept
+{
+    const size_t len1 = cstrview_len(v);
+    const size_t len2 = cstrview_len(prefix);
+    return len2 <= len1
+        && cstr_memcmp_(cstrview_data(v), cstrview_data(prefix), len2) == 0;
+}
+
+inline int cstrview_cmp(cstrview v1, cstrview v2) noexcept
+{
+    const size_t len1 = cstrview_len(v1);
+    const size_t len2 = cstrview_len(v2);
+    const int r = cstr_memcmp_(cstrview_data(v1), cstrview_data(v2), len1 < len2 ? len1 : len2);
+    return r != 0 ? r : (len1 > len2) - (len1 < len2);
+}
+
+inline int cstrview_eq(cstrview v1, cstrview v2) noexcept
+{
+    const size_t len = cstrview_len(v1);
+    return len == cstrview_len(v2)
+        && cstr_memcmp_(cstrview_data(v1), cstrview_data(v2), len) == 0;
+}
+
+struct cstrview_split_iter_t
+{
+    cstrview data;
+    cstrview value;
+};
+typedef struct cstrview_split_iter_t cstrview_split_iter;
+
+inline cstrview_split_iter cstrview_split_start(cstrview v, char c) noexcept
+{
+    cstrview_split_iter it;
+    it.data  = v;
+    it.value = cstrview_split(it.data, c);
+    return it;
+}
+
+inline cstrview_split_iter cstrview_split_next(cstrview_split_iter it, char c) noexcept
+{
+    it.data  = cstrview_drop(it.data, cstrview_len(it.value) + 1);
+    it.value = cstrview_split(it.data, c);
+    return it;
+}
+
+inline bool cstrview_split_stop(cstrview_split_iter it) noexcept
+{
+    return cstrview_empty(it.data);
+}
+
+inline cstrview cstrview_split_deref(cstrview_split_iter it) noexcept
+{
+    return it.value;
+}
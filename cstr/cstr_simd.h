@@ -0,0 +1,200 @@
+#ifndef CSTR_SIMD__H_
+#define CSTR_SIMD__H_
+
+// Search and compare kernels for cstrview, shared by cstr.c and
+// cstr_header.h. On x86 they use AVX2 when the CPU has it (checked once, or
+// not at all when built with -mavx2) and otherwise fall back to libc, which
+// also handles inputs shorter than a vector.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CSTR_SIMD_AVX2_ 1
+#define CSTR_TARGET_AVX2_ __attribute__((target("avx2")))
+#endif
+
+#ifdef CSTR_SIMD_AVX2_
+
+static inline int cstr_has_avx2_(void)
+{
+#ifdef __AVX2__
+    return 1;
+#else
+    static int has_avx2 = -1;
+    if (has_avx2 < 0) {
+        __builtin_cpu_init();
+        has_avx2 = __builtin_cpu_supports("avx2") != 0;
+    }
+    return has_avx2;
+#endif
+}
+
+CSTR_TARGET_AVX2_ static inline __m256i cstr_load_avx2_(const char* p)
+{
+    return _mm256_loadu_si256((const __m256i*)p);
+}
+
+CSTR_TARGET_AVX2_ static inline uint32_t cstr_eqmask_avx2_(const char* p, __m256i v)
+{
+    return (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(cstr_load_avx2_(p), v));
+}
+
+// n >= 32: the first 32 bytes on their own, since tokens are mostly short,
+// then 128 bytes per iteration, and the rest 32 at a time with the last
+// block overlapping bytes already searched (which are masked off)
+CSTR_TARGET_AVX2_ static inline const char* cstr_memchr_avx2_(const char* p, size_t n, char c)
+{
+    const __m256i needle = _mm256_set1_epi8(c);
+    const char* const end = p + n;
+    uint32_t m = cstr_eqmask_avx2_(p, needle);
+    if (m) {
+        return p + __builtin_ctz(m);
+    }
+    for (p += 32; end - p >= 128; p += 128) {
+        const __m256i e0 = _mm256_cmpeq_epi8(cstr_load_avx2_(p +  0), needle);
+        const __m256i e1 = _mm256_cmpeq_epi8(cstr_load_avx2_(p + 32), needle);
+        const __m256i e2 = _mm256_cmpeq_epi8(cstr_load_avx2_(p + 64), needle);
+        const __m256i e3 = _mm256_cmpeq_epi8(cstr_load_avx2_(p + 96), needle);
+        const __m256i any = _mm256_or_si256(_mm256_or_si256(e0, e1), _mm256_or_si256(e2, e3));
+        if (!_mm256_testz_si256(any, any)) {
+            const uint64_t lo = (uint64_t)(uint32_t)_mm256_movemask_epi8(e0)
+                              | (uint64_t)(uint32_t)_mm256_movemask_epi8(e1) << 32;
+            const uint64_t hi = (uint64_t)(uint32_t)_mm256_movemask_epi8(e2)
+                              | (uint64_t)(uint32_t)_mm256_movemask_epi8(e3) << 32;
+            return lo ? p + __builtin_ctzll(lo) : p + 64 + __builtin_ctzll(hi);
+        }
+    }
+    for (; end - p >= 32; p += 32) {
+        m = cstr_eqmask_avx2_(p, needle);
+        if (m) {
+            return p + __builtin_ctz(m);
+        }
+    }
+    if (p != end) {
+        const char* const q = end - 32;
+        m = cstr_eqmask_avx2_(q, needle) & (~0u << (p - q));
+        if (m) {
+            return q + __builtin_ctz(m);
+        }
+    }
+    return NULL;
+}
+
+// 2 <= k <= n: candidates are the positions where both the first and the
+// last char of the needle match (W. Mula's "generic SIMD" search). The last
+// block is moved back to end at the last candidate, masking off the ones
+// already checked; haystacks with fewer than 32 candidates go to memmem()
+CSTR_TARGET_AVX2_ static inline uint32_t cstr_memmem_block_avx2_(const char* h, const char* needle, size_t k,
+                                                                __m256i first, __m256i last)
+{
+    const __m256i f = _mm256_cmpeq_epi8(cstr_load_avx2_(h), first);
+    const __m256i l = _mm256_cmpeq_epi8(cstr_load_avx2_(h + k - 1), last);
+    uint32_t m = (uint32_t)_mm256_movemask_epi8(_mm256_and_si256(f, l));
+    for (; m; m &= m - 1) {
+        const unsigned j = (unsigned)__builtin_ctz(m);
+        if (memcmp(h + j + 1, needle + 1, k - 2) == 0) {
+            return j;
+        }
+    }
+    return 32;
+}
+
+CSTR_TARGET_AVX2_ static inline const char* cstr_memmem_avx2_(const char* h, size_t n,
+                                                             const char* needle, size_t k)
+{
+    const size_t ncandidates = n - k + 1;
+    if (ncandidates < 32) {
+        return (const char*)memmem(h, n, needle, k);
+    }
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last  = _mm256_set1_epi8(needle[k - 1]);
+    size_t i = 0;
+    for (; i + 32 <= ncandidates; i += 32) {
+        const uint32_t j = cstr_memmem_block_avx2_(h + i, needle, k, first, last);
+        if (j != 32) {
+            return h + i + j;
+        }
+    }
+    if (i != ncandidates) {
+        // candidates before i were checked already, and none matched
+        const size_t q = ncandidates - 32;
+        const uint32_t j = cstr_memmem_block_avx2_(h + q, needle, k, first, last);
+        if (j != 32) {
+            return h + q + j;
+        }
+    }
+    return NULL;
+}
+
+// n >= 32: 128 bytes per iteration while they are equal, then 32 at a time
+// to find the first difference; the last block may overlap bytes already
+// found equal, which is harmless
+CSTR_TARGET_AVX2_ static inline int cstr_memcmp_avx2_(const char* a, const char* b, size_t n)
+{
+    size_t i = 0;
+    for (; i + 128 <= n; i += 128) {
+        const __m256i e0 = _mm256_cmpeq_epi8(cstr_load_avx2_(a + i +  0), cstr_load_avx2_(b + i +  0));
+        const __m256i e1 = _mm256_cmpeq_epi8(cstr_load_avx2_(a + i + 32), cstr_load_avx2_(b + i + 32));
+        const __m256i e2 = _mm256_cmpeq_epi8(cstr_load_avx2_(a + i + 64), cstr_load_avx2_(b + i + 64));
+        const __m256i e3 = _mm256_cmpeq_epi8(cstr_load_avx2_(a + i + 96), cstr_load_avx2_(b + i + 96));
+        const __m256i all = _mm256_and_si256(_mm256_and_si256(e0, e1), _mm256_and_si256(e2, e3));
+        if ((uint32_t)_mm256_movemask_epi8(all) != ~0u) {
+            break;
+        }
+    }
+    for (; i < n; i += 32) {
+        if (n - i < 32) {
+            i = n - 32;
+        }
+        const uint32_t ne = ~(uint32_t)_mm256_movemask_epi8(
+                _mm256_cmpeq_epi8(cstr_load_avx2_(a + i), cstr_load_avx2_(b + i)));
+        if (ne) {
+            const size_t j = i + (size_t)__builtin_ctz(ne);
+            return (int)(unsigned char)a[j] - (int)(unsigned char)b[j];
+        }
+    }
+    return 0;
+}
+
+#endif // CSTR_SIMD_AVX2_
+
+static inline const char* cstr_memchr_(const char* p, size_t n, char c)
+{
+#ifdef CSTR_SIMD_AVX2_
+    if (n >= 32 && cstr_has_avx2_()) {
+        return cstr_memchr_avx2_(p, n, c);
+    }
+#endif
+    return (const char*)memchr(p, c, n);
+}
+
+static inline const char* cstr_memmem_(const char* h, size_t n, const char* needle, size_t k)
+{
+    if (k > n) {
+        return NULL;
+    }
+    if (k <= 1) {
+        return k == 0 ? h : cstr_memchr_(h, n, needle[0]);
+    }
+#ifdef CSTR_SIMD_AVX2_
+    if (n >= 32 && cstr_has_avx2_()) {
+        return cstr_memmem_avx2_(h, n, needle, k);
+    }
+#endif
+    return (const char*)memmem(h, n, needle, k);
+}
+
+static inline int cstr_memcmp_(const char* a, const char* b, size_t n)
+{
+#ifdef CSTR_SIMD_AVX2_
+    if (n >= 32 && cstr_has_avx2_()) {
+        return cstr_memcmp_avx2_(a, b, n);
+    }
+#endif
+    return memcmp(a, b, n);
+}
+
+#endif // CSTR_SIMD__H_
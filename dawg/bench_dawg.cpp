@@ -0,0 +1,143 @@
+#include <benchmark/benchmark.h>
+#include <array>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include "mafsa.h"
+#include "../mafsa/bench_data.h"
+#include "../mafsa/darray2.h"
+#include "../mafsa/tarraysep.h"
+#include "../mafsa/mafsa2.h"
+
+// Same dictionaries that `bench_arrays` uses so the numbers are comparable.
+static const std::array<std::string, 3> DictionaryFilenames = {
+    "csw19.ddic.gz",
+    "csw19.tdic.gz",
+    "csw19.mfsa.gz",
+};
+constexpr std::size_t DarrayDictionary = 0;
+constexpr std::size_t TarrayDictionary = 1;
+constexpr std::size_t  MafsaDictionary = 2;
+
+static std::size_t countbytes()
+{
+    std::size_t result = 0;
+    for (const auto& word : words) {
+        result += word.size();
+    }
+    return result;
+}
+
+static const std::size_t total_word_bytes = countbytes();
+
+template <class T>
+static T deserialize_or_throw(const std::string& filename)
+{
+    auto maybe_dict = T::deserialize(filename);
+    if (!maybe_dict) {
+        throw std::runtime_error("failed to deserialize " + filename);
+    }
+    return std::move(*maybe_dict);
+}
+
+// The serialized MA-FSA is already reduced, so rebuild a `dawg::Mafsa` from it
+// instead of re-running the (quadratic) `Mafsa::reduce()` on the raw word list.
+static dawg::Mafsa make_dawg_mafsa(const Mafsa2& m2)
+{
+    dawg::Mafsa m;
+    m.ns.resize(m2.nodes.size());
+    for (std::size_t i = 0; i < m2.nodes.size(); ++i) {
+        auto& node = m.ns[i];
+        node.term = m2.terms[i];
+        for (int c = 0; c < 26; ++c) {
+            const int next = m2.nodes[i].children[c];
+            if (next == 0) {
+                continue;
+            }
+            node.kids[c] = next;
+            // all edges into a state in the reduced MA-FSA share a label
+            m.ns[static_cast<std::size_t>(next)].val = c;
+        }
+    }
+    m.ns[0].val = -1;
+    return m;
+}
+
+static const dawg::Mafsa& reduced_mafsa()
+{
+    static const dawg::Mafsa m = make_dawg_mafsa(
+            deserialize_or_throw<Mafsa2>(DictionaryFilenames[MafsaDictionary]));
+    return m;
+}
+
+template <class T> static const T& dictionary();
+
+template <> const dawg::SDFA& dictionary<dawg::SDFA>()
+{
+    static const dawg::SDFA dict = dawg::SDFA::make(reduced_mafsa());
+    return dict;
+}
+
+template <> const dawg::SDFA2& dictionary<dawg::SDFA2>()
+{
+    static const dawg::SDFA2 dict = dawg::SDFA2::make(reduced_mafsa());
+    return dict;
+}
+
+template <> const dawg::Tatrie& dictionary<dawg::Tatrie>()
+{
+    static const dawg::Tatrie dict = dawg::Tatrie::make(reduced_mafsa());
+    return dict;
+}
+
+template <> const Darray2& dictionary<Darray2>()
+{
+    static const Darray2 dict = deserialize_or_throw<Darray2>(DictionaryFilenames[DarrayDictionary]);
+    return dict;
+}
+
+template <> const Tarraysep& dictionary<Tarraysep>()
+{
+    static const Tarraysep dict = deserialize_or_throw<Tarraysep>(DictionaryFilenames[TarrayDictionary]);
+    return dict;
+}
+
+template <> const Mafsa2& dictionary<Mafsa2>()
+{
+    static const Mafsa2 dict = deserialize_or_throw<Mafsa2>(DictionaryFilenames[MafsaDictionary]);
+    return dict;
+}
+
+static std::size_t memory_usage(const dawg::SDFA& d)   { return d.tt.size() * sizeof(d.tt[0]); }
+static std::size_t memory_usage(const dawg::SDFA2& d)  { return d.bytes(); }
+static std::size_t memory_usage(const dawg::Tatrie& d) { return (d.bases.size() + d.checks.size() + d.nexts.size()) * 4; }
+static std::size_t memory_usage(const Darray2& d)      { return (d.bases.size() + d.checks.size()) * 4; }
+static std::size_t memory_usage(const Tarraysep& d)    { return (d.bases.size() + d.checks.size() + d.nexts.size()) * 4; }
+static std::size_t memory_usage(const Mafsa2& d)       { return d.nodes.size() * sizeof(d.nodes[0]) + d.terms.size() / 8; }
+
+template <class T>
+static void BM_IsWord_AllWords(benchmark::State& state)
+{
+    const auto& dict = dictionary<T>();
+    bool is_word = true;
+    for (auto _ : state) {
+        for (const auto& word : words) {
+            is_word &= dict.isword(word);
+        }
+    }
+    state.SetBytesProcessed(state.iterations() * total_word_bytes);
+    state.counters["bytes"] = static_cast<double>(memory_usage(dict));
+    if (!is_word) {
+        throw std::runtime_error("test failed");
+    }
+}
+BENCHMARK_TEMPLATE(BM_IsWord_AllWords, dawg::SDFA);
+BENCHMARK_TEMPLATE(BM_IsWord_AllWords, dawg::SDFA2);
+BENCHMARK_TEMPLATE(BM_IsWord_AllWords, dawg::Tatrie);
+BENCHMARK_TEMPLATE(BM_IsWord_AllWords, Darray2);
+BENCHMARK_TEMPLATE(BM_IsWord_AllWords, Tarraysep);
+BENCHMARK_TEMPLATE(BM_IsWord_AllWords, Mafsa2);
+
+
+BENCHMARK_MAIN();
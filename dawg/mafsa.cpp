@@ -3,9 +3,13 @@
 #include <iostream>
 #include <cstring>
 #include <algorithm>
+#include <numeric>
+#include <type_traits>
 
 #define DEBUG(fmt, ...) fprintf(stderr, "DEBUG: " fmt "\n", ##__VA_ARGS__);
 
+namespace dawg {
+
 Mafsa::Mafsa()
 {
     ns.emplace_back();
@@ -274,6 +278,95 @@ bool SDFA::isword(const char* const word) const
     return result;
 }
 
+template <class T>
+bool SDFA2::isword_(const std::vector<T>& tt, const char* const word) const
+{
+    u32 s = 0;
+    for (const char* p = word; *p != '\0'; ++p) {
+        const u32 c = column[static_cast<unsigned char>(*p)];
+        if (c == NOCOLUMN) {
+            return false;
+        }
+        const u32 t = tt[s * NumLetters + c];
+        if (t == NOTRANSITION) {
+            return false;
+        }
+        s = t;
+    }
+    return s != 0 ? s >= term_begin : root_term;
+}
+
+bool SDFA2::isword(const char* const word) const
+{
+    return narrow() ? isword_(tt16, word) : isword_(tt32, word);
+}
+
+/*static*/ SDFA2 SDFA2::make(const Mafsa& m)
+{
+    SDFA2 result;
+    const std::size_t n_states = m.ns.size();
+
+    // order columns by how many transitions use each letter
+    std::size_t counts[NumLetters] = { 0 };
+    for (std::size_t index = 0; index < n_states; ++index) {
+        assert(m.validstate(index));
+        for (auto [val, next_state] : m.ns[index].kids) {
+            assert(0 <= val && static_cast<u32>(val) < NumLetters);
+            ++counts[val];
+        }
+    }
+    int letters[NumLetters];
+    std::iota(std::begin(letters), std::end(letters), 0);
+    std::stable_sort(std::begin(letters), std::end(letters),
+            [&](int a, int b) { return counts[a] > counts[b]; });
+    u8 letter_to_column[NumLetters];
+    for (u32 i = 0; i < NumLetters; ++i) {
+        letter_to_column[letters[i]] = static_cast<u8>(i);
+    }
+    std::fill(std::begin(result.column), std::end(result.column), NOCOLUMN);
+    for (u32 i = 0; i < NumLetters; ++i) {
+        result.column[static_cast<u8>('A' + i)] = letter_to_column[i];
+        result.column[static_cast<u8>('a' + i)] = letter_to_column[i];
+    }
+
+    // renumber: root, then non-terminal states, then terminal states
+    std::vector<u32> conv(n_states, 0);
+    u32 next_id = 1;
+    for (int pass = 0; pass < 2; ++pass) {
+        const bool want_term = pass == 1;
+        if (want_term) {
+            result.term_begin = next_id;
+        }
+        for (std::size_t index = 1; index < n_states; ++index) {
+            if (m.ns[index].term == want_term) {
+                conv[index] = next_id++;
+            }
+        }
+    }
+    assert(next_id == n_states || n_states == 0);
+    result.root_term = n_states != 0 && m.ns[0].term;
+
+    auto fill = [&](auto& tt)
+    {
+        using T = typename std::decay_t<decltype(tt)>::value_type;
+        tt.assign(n_states * NumLetters, static_cast<T>(NOTRANSITION));
+        for (std::size_t index = 0; index < n_states; ++index) {
+            const std::size_t base = conv[index] * NumLetters;
+            for (auto [val, next_state] : m.ns[index].kids) {
+                const auto next_id_ = conv[static_cast<std::size_t>(next_state)];
+                assert(next_id_ != NOTRANSITION);
+                tt[base + letter_to_column[val]] = static_cast<T>(next_id_);
+            }
+        }
+    };
+    if (n_states <= (1u << 16)) {
+        fill(result.tt16);
+    } else {
+        fill(result.tt32);
+    }
+    return result;
+}
+
 bool Tatrie::isword(const char* const word) const
 {
     int s = 0;
@@ -349,7 +442,7 @@ const int* findbase(const int* const ckbegin, const int* const ckend, const int*
     {
         for (const int* valp = vbegin; valp != vend; ++valp) {
             const int val = *valp - *vbegin;
-            assert((ckbegin + val) < ckend);
+            assert((check + val) < (ckend + (*(vend - 1) - *vbegin)));
             if (check[val] != Tatrie::UNSET_CHECK) {
                 return false;
             }
@@ -442,3 +535,5 @@ const int* findbase(const int* const ckbegin, const int* const ckend, const int*
 
     return result;
 }
+
+} // namespace dawg
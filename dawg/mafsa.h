@@ -6,6 +6,9 @@
 #include <cassert>
 #include <cstdint>
 
+// NOTE: namespaced so that these can be linked alongside the layouts in mafsa/,
+//       which also define a `Mafsa` type.
+namespace dawg {
 
 struct Mafsa
 {
@@ -79,6 +82,44 @@ struct SDFA
     static SDFA make(const Mafsa& m);
 };
 
+// SDFA with states renumbered so that the transition table can use the
+// narrowest index type that fits (u16 for < 64k states) and columns ordered by
+// letter frequency so the hot transitions of a row share a cache line.
+//
+// State 0 is the root (and doubles as "no transition" since nothing links back
+// to the root). Non-terminal states come next, then all terminal states, so a
+// state is terminal iff `s >= term_begin` -- no bit stolen from the index.
+struct SDFA2
+{
+    using u8  = uint8_t;
+    using u16 = uint16_t;
+    using u32 = uint32_t;
+
+    static constexpr u32 NOTRANSITION = 0;
+    static constexpr u32 NumLetters   = 26;
+    static constexpr u8  NOCOLUMN     = 0xFF;
+
+    u8   column[256];    // char -> column in the transition table
+    u32  term_begin = 0; // first terminal state
+    bool root_term  = false;
+
+    // only one of these is populated, picked by `make()` from the state count
+    std::vector<u16> tt16;
+    std::vector<u32> tt32;
+
+    bool isword(const char* const word) const;
+    bool isword(const std::string& word) const { return isword(word.c_str()); }
+    bool narrow() const { return !tt16.empty(); }
+    std::size_t size() const { return narrow() ? tt16.size() : tt32.size(); }
+    std::size_t bytes() const { return tt16.size() * sizeof(u16) + tt32.size() * sizeof(u32); }
+
+    static SDFA2 make(const Mafsa& m);
+
+private:
+    template <class T>
+    bool isword_(const std::vector<T>& tt, const char* const word) const;
+};
+
 struct Tatrie
 {
     using u32 = uint32_t;
@@ -117,3 +158,5 @@ struct Tatrie
 private:
     void setbase(std::size_t s, int base, bool term);
 };
+
+} // namespace dawg
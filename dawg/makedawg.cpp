@@ -6,68 +6,41 @@
 #include <chrono>
 #include "dawg.h"
 #include "mafsa.h"
+#include "wordlist.h"
+
+using dawg::Mafsa;
+using dawg::SDFA;
+using dawg::Tatrie;
 
 
 template <class F>
 bool foreach_in_dictionary(std::string path, int max_words, std::string action, F&& f)
 {
-    int n_words = 0;
-    std::string word;
-    std::ifstream ifs{path};
-    if (!ifs) {
-        std::cerr << "error: unable to open input file\n";
-        return false;
-    }
-    while (ifs >> word) {
-        if (word.empty()) {
-            continue;
-        }
-        if (word.size() < 2 || word.size() > 15) {
-            std::cerr << "warning: skipping invalid word: \"" << word << "\"\n";
-        }
-        bool valid_word = true;
-        for (std::size_t i = 0; i < word.size(); ++i) {
-            char c = word[i];
-            if ('a' <= c && c <= 'z') {
-                word[i] = static_cast<char>((c - 'a') + 'A');
-            } else if ('A' <= c && c <= 'Z') {
-                word[i] = c;
-            } else {
-                std::cerr << "warning: invalid character '" << c << "' in word \"" << word << "\"\n";
-                valid_word = false;
-                break;
-            }
-        }
-        if (valid_word) {
+    return foreach_in_dictionary(path, max_words, [&](const char* word)
+        {
             const bool ok = f(word);
-            // const bool ok = insert2(trie, word.c_str());
             if (!ok) {
                 std::cerr << "Failed to " << action << " the word \"" << word << "\"" << std::endl;
-                return false;
-            }
-            if (++n_words >= max_words) {
-                break;
             }
-        }
-    }
-    return true;
+            return ok;
+        });
 }
 
 
 bool load_dictionary(Datrie2* trie, std::string path, int max_words=INT_MAX)
 {
     return foreach_in_dictionary(path, max_words, /*action*/"insert",
-        [trie](const std::string& word)
+        [trie](const char* word)
         {
-            return insert2(trie, word.c_str());
+            return insert2(trie, word);
         });
 }
 
 bool test_trie(Datrie2* trie, std::string path, int max_words=INT_MAX) {
     return foreach_in_dictionary(path, max_words, /*action*/"find",
-        [trie](const std::string& word)
+        [trie](const char* word)
         {
-            auto res = isword2(trie, word.c_str());
+            auto res = isword2(trie, word);
             if (res != Tristate::eWord) {
                 std::cerr << "Word: \"" << word << "\": " << tristate_to_str(res) << "\n";
             }
@@ -77,7 +50,7 @@ bool test_trie(Datrie2* trie, std::string path, int max_words=INT_MAX) {
 
 bool load_dict_mafsa(Mafsa& m, std::string path, int max_words=INT_MAX) {
     return foreach_in_dictionary(path, max_words, /*action*/"insert",
-        [&m](const std::string& word)
+        [&m](const char* word)
         {
             m.insert(word);
             return true;
@@ -90,7 +63,7 @@ bool test_dfa(const T& m, std::string path, int max_words=INT_MAX) {
 
     auto start = std::chrono::steady_clock::now();
     auto result = foreach_in_dictionary(path, max_words, /*action*/"find",
-        [&m](const std::string& word) { return m.isword(word); });
+        [&m](const char* word) { return m.isword(word); });
     auto stop  = std::chrono::steady_clock::now();
     std::chrono::duration<double> diff = stop - start;
     std::cout << "TestDFA took " << diff.count() << " seconds";
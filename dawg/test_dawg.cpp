@@ -12,6 +12,11 @@
 
 #include "mafsa.h"
 
+using dawg::Mafsa;
+using dawg::SDFA;
+using dawg::SDFA2;
+using dawg::Tatrie;
+
 std::ostream& operator<<(std::ostream& os, Tristate t)
 {
     os << tristate_to_str(t);
@@ -408,6 +413,60 @@ TEST_CASE("SDFA")
     }
 }
 
+TEST_CASE("SDFA2")
+{
+    SECTION("Reduced dictionary uses 16-bit states")
+    {
+        Mafsa m;
+        for (const auto& word : DICT) {
+            m.insert(word);
+        }
+        m.reduce();
+
+        SDFA2 tt = SDFA2::make(m);
+        CHECK(tt.narrow());
+        CHECK(tt.bytes() == tt.size() * sizeof(uint16_t));
+
+        for (const auto& word : DICT) {
+            CHECK(tt.isword(word));
+        }
+        for (const auto& word : MISSING) {
+            CHECK(!tt.isword(word));
+        }
+        CHECK(!tt.isword(""));
+        CHECK(!tt.isword("AA1"));
+    }
+
+    SECTION("Large automaton falls back to 32-bit states")
+    {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<> dis('A', 'Z');
+        std::set<std::string> words;
+        while (words.size() < 20000) {
+            std::string word;
+            for (int i = 0; i < 6; ++i) {
+                word += static_cast<char>(dis(gen));
+            }
+            words.insert(word);
+        }
+
+        Mafsa m;
+        for (const auto& word : words) {
+            m.insert(word);
+        }
+        REQUIRE(m.ns.size() > (1u << 16));
+
+        SDFA2 tt = SDFA2::make(m);
+        CHECK(!tt.narrow());
+        for (const auto& word : words) {
+            CHECK(tt.isword(word));
+        }
+        for (const auto& word : words) {
+            CHECK(!tt.isword(word.substr(0, 5)));
+        }
+    }
+}
+
 inline std::ostream& operator<<(std::ostream& os, const Mafsa::Node& n)
 {
     [[maybe_unused]] auto tochar  = [](int v)  { return static_cast<char>(v + 'A'); };
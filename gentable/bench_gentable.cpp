@@ -0,0 +1,293 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "gentable_v1.h"
+#include "gentable_v2.h"
+#include "gentable_v3.h"
+#include "gentable_v4.h"
+#include "stl_table.h"
+
+// The gentables against std::unordered_map (STLTable), on input sets shaped
+// like gen_test_cases.py output but made here: M generation keys, N entries
+// per generation and M ys that aren't in the table. Every iteration works on
+// whole sets, so items/s is per table operation.
+
+constexpr std::size_t N = gentbl::v1::Table::N;
+constexpr std::size_t M = 64;
+
+struct Entry
+{
+    uint32_t y;
+    uint64_t z;
+};
+
+struct InputSet
+{
+    std::vector<uint32_t> keys;
+    std::vector<Entry>    vals;
+    std::vector<uint32_t> miss;
+};
+
+static InputSet make_input_set(std::size_t nvals, std::size_t nkeys = M, std::size_t nmiss = M)
+{
+    std::mt19937_64 gen(42);
+    // 0 is a reserved value
+    auto u32 = [&] { return static_cast<uint32_t>(gen() % 0xffffffffu) + 1u; };
+    auto u64 = [&] { return gen() % 0xffffffffffffffffu + 1u; };
+    std::unordered_set<uint32_t> ys;
+    InputSet input;
+
+    for (std::size_t i = 0; i != nkeys; ++i) {
+        input.keys.push_back(u32());
+    }
+    while (input.vals.size() != nvals) {
+        const uint32_t y = u32();
+        if (ys.insert(y).second) {
+            input.vals.push_back({ y, u64() });
+        }
+    }
+    while (input.miss.size() != nmiss) {
+        const uint32_t y = u32();
+        if (ys.count(y) == 0) {
+            input.miss.push_back(y);
+        }
+    }
+    return input;
+}
+
+using UncappedSTLTable = BasicSTLTable<std::size_t(-1)>;
+
+template <class T>
+static T make_table(std::size_t)
+{
+    return T{};
+}
+
+template <>
+gentbl::v3::Table make_table<gentbl::v3::Table>(std::size_t capacity)
+{
+    return gentbl::v3::Table(capacity);
+}
+
+template <class T>
+static void fill(T& t, uint32_t x, const std::vector<Entry>& vals)
+{
+    for (const auto& e : vals) {
+        t.insert(x, e.y, e.z);
+    }
+}
+
+// a whole generation into a table full of the previous one
+template <class T>
+static void BM_Insert(benchmark::State& state)
+{
+    const auto input = make_input_set(N);
+    auto t = make_table<T>(N);
+    std::size_t k = 0;
+    for (auto _ : state) {
+        const uint32_t x = input.keys[k++ % input.keys.size()];
+        for (const auto& e : input.vals) {
+            benchmark::DoNotOptimize(t.insert(x, e.y, e.z));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * input.vals.size()));
+}
+
+template <class T>
+static void BM_FindHit(benchmark::State& state)
+{
+    const auto input = make_input_set(N);
+    const uint32_t x = input.keys[0];
+    auto t = make_table<T>(N);
+    fill(t, x, input.vals);
+    for (auto _ : state) {
+        for (const auto& e : input.vals) {
+            benchmark::DoNotOptimize(t.find(x, e.y));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * input.vals.size()));
+}
+
+template <class T>
+static void BM_FindMiss(benchmark::State& state)
+{
+    const auto input = make_input_set(N);
+    const uint32_t x = input.keys[0];
+    auto t = make_table<T>(N);
+    fill(t, x, input.vals);
+    for (auto _ : state) {
+        for (const auto y : input.miss) {
+            benchmark::DoNotOptimize(t.find(x, y));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * input.miss.size()));
+}
+
+// state.range(0) entries in the current generation
+template <class T>
+static void BM_Size(benchmark::State& state)
+{
+    auto input = make_input_set(N);
+    input.vals.resize(static_cast<std::size_t>(state.range(0)));
+    const uint32_t x = input.keys[0];
+    auto t = make_table<T>(N);
+    fill(t, x, input.vals);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(t.size(x));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// every insert starts a new generation, over a table full of old ones
+template <class T>
+static void BM_Rollover(benchmark::State& state)
+{
+    const auto input = make_input_set(N);
+    auto t = make_table<T>(N);
+    fill(t, input.keys[0], input.vals);
+    std::size_t k = 1;
+    for (auto _ : state) {
+        const uint32_t x = input.keys[k % input.keys.size()];
+        const auto& e = input.vals[k % input.vals.size()];
+        benchmark::DoNotOptimize(t.insert(x, e.y, e.z));
+        benchmark::DoNotOptimize(t.find(x, e.y));
+        ++k;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+#define GENTABLE_BENCHMARKS(T)                                   \
+    BENCHMARK_TEMPLATE(BM_Insert, T);                            \
+    BENCHMARK_TEMPLATE(BM_FindHit, T);                           \
+    BENCHMARK_TEMPLATE(BM_FindMiss, T);                          \
+    BENCHMARK_TEMPLATE(BM_Size, T)->Arg(0)->Arg(N / 2)->Arg(N);  \
+    BENCHMARK_TEMPLATE(BM_Rollover, T)
+
+GENTABLE_BENCHMARKS(STLTable);
+GENTABLE_BENCHMARKS(gentbl::v1::Table);
+GENTABLE_BENCHMARKS(gentbl::v4::Table);
+
+// v1 behind a reader/writer lock, the obvious way to share it between threads
+struct LockedTable
+{
+    bool insert(uint32_t x, uint32_t y, uint64_t z) noexcept
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        return t.insert(x, y, z);
+    }
+
+    uint64_t find(uint32_t x, uint32_t y) const noexcept
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return t.find(x, y);
+    }
+
+    int size(uint32_t x) const noexcept
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        return t.size(x);
+    }
+
+    mutable std::shared_mutex mutex;
+    gentbl::v1::Table t;
+};
+
+// Thread 0 keeps writing whole generations while the other threads look up
+// the entries of the latest one; items/s counts the readers' finds only.
+template <class T>
+static void BM_ConcurrentFind(benchmark::State& state)
+{
+    static const auto input = make_input_set(N);
+    static std::unique_ptr<T> t;
+    static std::atomic<uint32_t> current;
+
+    if (state.thread_index() == 0) {
+        // the readers wait for this at the start of their loop
+        t = std::make_unique<T>();
+        fill(*t, input.keys[0], input.vals);
+        current.store(input.keys[0], std::memory_order_relaxed);
+        std::size_t k = 0;
+        for (auto _ : state) {
+            const uint32_t x = input.keys[++k % input.keys.size()];
+            fill(*t, x, input.vals);
+            current.store(x, std::memory_order_relaxed);
+        }
+    } else {
+        for (auto _ : state) {
+            const uint32_t x = current.load(std::memory_order_relaxed);
+            for (const auto& e : input.vals) {
+                benchmark::DoNotOptimize(t->find(x, e.y));
+            }
+        }
+        state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * input.vals.size()));
+    }
+    // every thread has left the loop once the last one does
+    if (state.thread_index() == 0) {
+        t.reset();
+    }
+}
+BENCHMARK_TEMPLATE(BM_ConcurrentFind, LockedTable)->ThreadRange(2, 8)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ConcurrentFind, gentbl::v4::Table)->ThreadRange(2, 8)->UseRealTime();
+
+// the tables built for an instruction set are only registered where this
+// CPU can run them; every v2 variant is, so the ISAs can be compared directly
+template <class T>
+static void register_table(const std::string& name)
+{
+    if (!T::supported()) {
+        return;
+    }
+    const std::string t = "<" + name + ">";
+    benchmark::RegisterBenchmark(("BM_Insert" + t).c_str(), BM_Insert<T>);
+    benchmark::RegisterBenchmark(("BM_FindHit" + t).c_str(), BM_FindHit<T>);
+    benchmark::RegisterBenchmark(("BM_FindMiss" + t).c_str(), BM_FindMiss<T>);
+    benchmark::RegisterBenchmark(("BM_Size" + t).c_str(), BM_Size<T>)->Arg(0)->Arg(N / 2)->Arg(N);
+    benchmark::RegisterBenchmark(("BM_Rollover" + t).c_str(), BM_Rollover<T>);
+}
+
+// insert a whole generation of up to 64k entries, then find every entry of
+// it; only v3 and an uncapped STLTable can hold more than N
+template <class T>
+static void BM_Generation(benchmark::State& state)
+{
+    const auto input = make_input_set(static_cast<std::size_t>(state.range(0)));
+    auto t = make_table<T>(input.vals.size());
+    std::size_t k = 0;
+    for (auto _ : state) {
+        const uint32_t x = input.keys[k++ % input.keys.size()];
+        for (const auto& e : input.vals) {
+            benchmark::DoNotOptimize(t.insert(x, e.y, e.z));
+        }
+        for (const auto& e : input.vals) {
+            benchmark::DoNotOptimize(t.find(x, e.y));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(2 * state.iterations() * input.vals.size()));
+}
+BENCHMARK_TEMPLATE(BM_Generation, UncappedSTLTable)->RangeMultiplier(4)->Range(32, 64 << 10);
+
+int main(int argc, char** argv)
+{
+    register_table<gentbl::v2::TableSse2>("gentbl::v2::TableSse2");
+    register_table<gentbl::v2::TableAvx2>("gentbl::v2::TableAvx2");
+    register_table<gentbl::v2::TableAvx512>("gentbl::v2::TableAvx512");
+    register_table<gentbl::v3::Table>("gentbl::v3::Table");
+    if (gentbl::v3::Table::supported()) {
+        benchmark::RegisterBenchmark("BM_Generation<gentbl::v3::Table>", BM_Generation<gentbl::v3::Table>)
+            ->RangeMultiplier(4)->Range(32, 64 << 10);
+    }
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
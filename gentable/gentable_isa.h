@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <cpuid.h>
+
+// Runtime instruction set detection for the table kernels that are built for
+// several ISAs (see gentable_v2.h).
+
+namespace gentbl {
+
+// narrowest first, each one a superset of the one before
+enum class Isa { Sse2, Avx2, Avx512 };
+
+inline const char* isa_name(Isa isa) noexcept
+{
+    switch (isa) {
+    case Isa::Avx512: return "avx512";
+    case Isa::Avx2:   return "avx2";
+    case Isa::Sse2:   return "sse2";
+    }
+    return "unknown";
+}
+
+// The widest ISA both the CPU and the OS (saved register state) support.
+inline Isa detect_isa() noexcept
+{
+    unsigned eax, ebx, ecx, edx;
+    uint64_t xcr0 = 0;
+
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return Isa::Sse2;
+    }
+    if (ecx & bit_OSXSAVE) {
+        uint32_t lo, hi;
+        __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+        xcr0 = (static_cast<uint64_t>(hi) << 32) | lo;
+    }
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx)) {
+        return Isa::Sse2;
+    }
+    // XMM|YMM state for AVX2, plus opmask and ZMM state for AVX-512
+    if (!(ebx & bit_AVX2) || (xcr0 & 0x06) != 0x06) {
+        return Isa::Sse2;
+    }
+    if (!(ebx & bit_AVX512F) || (xcr0 & 0xE6) != 0xE6) {
+        return Isa::Avx2;
+    }
+    return Isa::Avx512;
+}
+
+inline Isa best_isa() noexcept
+{
+    static const Isa isa = detect_isa();
+    return isa;
+}
+
+} // namespace gentbl
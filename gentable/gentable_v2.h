@@ -3,6 +3,7 @@
 #include <cstdint>
 #include <immintrin.h>
 #include <fmt/ostream.h> // TEMP TEMP
+#include "gentable_isa.h"
 
 
 // TODO: clean this up
@@ -10,108 +11,232 @@
 #define UNLIKELY(x) __builtin_expect(!!(x), false)
 #define restrict __restrict
 
+// The v2 table is built once per instruction set: TableSse2, TableAvx2 and
+// TableAvx512 share gentable_v2_impl.h and differ only in the kernels that
+// turn the xs/ys compares into a 32-bit slot mask, and in STRIDE/ALIGN.
+// Each is compiled for its own target with `#pragma GCC target`, so none of
+// them needs -m flags and any one can be used where its ISA is available;
+// dispatch() picks the widest one this CPU supports at runtime.
+//
+// Calls into a variant from code not compiled for its ISA aren't inlined,
+// so put the whole hot loop behind dispatch() rather than every call.
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+
 namespace gentbl {
 
-namespace v1 {
+namespace v2 {
 
-struct Table
+// Eight 4-slot compares, narrowed to bytes with two rounds of saturating
+// packs (which keep slot order on 128-bit vectors) and two movemasks.
+struct Sse2Kernels
 {
-public:
-    constexpr static std::size_t N = 32;
-    constexpr static std::size_t NO_SLOT = -1;
-    constexpr static uint64_t    INVALID = 0;
-    constexpr static std::size_t BITS_PER_OP  = 256;
-    constexpr static std::size_t BITS_PER_KEY = 32;
-    constexpr static std::size_t STRIDE = BITS_PER_OP / BITS_PER_KEY;
-    constexpr static std::size_t ALIGN = 32;
-    static_assert((N % STRIDE) == 0);
+    constexpr static Isa         ISA = Isa::Sse2;
+    constexpr static std::size_t STRIDE = 128 / 32;
+    constexpr static std::size_t ALIGN = 16;
 
-    bool insert(uint32_t x, uint32_t y, uint64_t z) noexcept
+    static __m128i load(const uint32_t* p) noexcept
     {
-        auto slot = find_open_slot(x, xs);
-        if (LIKELY(slot != NO_SLOT)) {
-            xs[slot] = x;
-            ys[slot] = y;
-            zs[slot] = z;
-            return true;
-        }
-        return false;
+        return _mm_load_si128(reinterpret_cast<const __m128i*>(p));
     }
 
-    uint64_t find(uint32_t x, uint32_t y) const noexcept
+    static uint32_t to_mask(const __m128i (&c)[8]) noexcept
     {
-        auto slot = find_slot(x, xs, y, ys);
-        if (LIKELY(slot == NO_SLOT)) {
-            return INVALID;
-        }
-        return zs[slot];
+        const __m128i lo = _mm_packs_epi16(_mm_packs_epi32(c[0], c[1]), _mm_packs_epi32(c[2], c[3]));
+        const __m128i hi = _mm_packs_epi16(_mm_packs_epi32(c[4], c[5]), _mm_packs_epi32(c[6], c[7]));
+        return static_cast<uint32_t>(_mm_movemask_epi8(lo)) |
+               static_cast<uint32_t>(_mm_movemask_epi8(hi)) << 16;
     }
 
-    int size(uint32_t x) const noexcept
+    static uint32_t match_mask(uint32_t x, const uint32_t* restrict xs) noexcept
     {
-        return count_slots(x, xs);
+        const __m128i needle = _mm_set1_epi32(static_cast<int>(x));
+        __m128i c[8];
+        for (std::size_t i = 0; i != 8; ++i) {
+            c[i] = _mm_cmpeq_epi32(needle, load(&xs[i * STRIDE]));
+        }
+        return to_mask(c);
     }
 
-    // TEMP TEMP
-    void dump(std::ostream& os)
+    static uint32_t match_mask(
+            uint32_t x, const uint32_t* restrict xs,
+            uint32_t y, const uint32_t* restrict ys) noexcept
     {
-        fmt::print(os, "Table = {{\n");
-        for (std::size_t i = 0; i != N; ++i) {
-            fmt::print(os, "    {:08x} {:08x} {:016x}\n", xs[i], ys[i], zs[i]);
+        const __m128i xneedle = _mm_set1_epi32(static_cast<int>(x));
+        const __m128i yneedle = _mm_set1_epi32(static_cast<int>(y));
+        __m128i c[8];
+        for (std::size_t i = 0; i != 8; ++i) {
+            c[i] = _mm_and_si128(_mm_cmpeq_epi32(xneedle, load(&xs[i * STRIDE])),
+                                 _mm_cmpeq_epi32(yneedle, load(&ys[i * STRIDE])));
         }
-        fmt::print(os, "}}\n");
+        return to_mask(c);
+    }
+};
+
+} // namespace v2
+
+} // namespace gentbl
+
+#define GENTBL_V2_TABLE   TableSse2
+#define GENTBL_V2_KERNELS Sse2Kernels
+#include "gentable_v2_impl.h"
+#undef GENTBL_V2_TABLE
+#undef GENTBL_V2_KERNELS
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+namespace gentbl {
+
+namespace v2 {
+
+// Four 8-slot compares, narrowed to bytes with two rounds of saturating
+// packs, put back in slot order with one permute and turned into the
+// 32-bit mask with a single movemask.
+struct Avx2Kernels
+{
+    constexpr static Isa         ISA = Isa::Avx2;
+    constexpr static std::size_t STRIDE = 256 / 32;
+    constexpr static std::size_t ALIGN = 32;
+
+    static __m256i load(const uint32_t* p) noexcept
+    {
+        return _mm256_load_si256(reinterpret_cast<const __m256i*>(p));
     }
 
-private:
-    static std::size_t find_open_slot(
-            uint32_t x, const uint32_t* restrict xs) noexcept
+    static uint32_t to_mask(__m256i c0, __m256i c1, __m256i c2, __m256i c3) noexcept
     {
-        std::size_t i;
-        __m256i needle;
-        __m256i haystk;
-        __m256i result;
-        needle = _mm256_set1_epi32(x);
-        for (i = 0; i != N; i += STRIDE) {
-            haystk = _mm256_load_si256(&xs[i]);
-            result = _mm256_cmpeq_epi32(needle, haystk);
-        }
+        const __m256i c01 = _mm256_packs_epi32(c0, c1);
+        const __m256i c23 = _mm256_packs_epi32(c2, c3);
+        const __m256i c   = _mm256_packs_epi16(c01, c23);
+        // packs work within 128-bit lanes: dwords are now in group order
+        // 0 2 4 6 1 3 5 7
+        const __m256i fix = _mm256_permutevar8x32_epi32(c, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+        return static_cast<uint32_t>(_mm256_movemask_epi8(fix));
+    }
 
-        for (std::size_t i = 0; i != N; ++i) {
-            if (xs[i] != x) {
-                return i;
-            }
-        }
-        return NO_SLOT;
+    static uint32_t match_mask(uint32_t x, const uint32_t* restrict xs) noexcept
+    {
+        const __m256i needle = _mm256_set1_epi32(static_cast<int>(x));
+        return to_mask(_mm256_cmpeq_epi32(needle, load(&xs[0 * STRIDE])),
+                       _mm256_cmpeq_epi32(needle, load(&xs[1 * STRIDE])),
+                       _mm256_cmpeq_epi32(needle, load(&xs[2 * STRIDE])),
+                       _mm256_cmpeq_epi32(needle, load(&xs[3 * STRIDE])));
     }
 
-    static std::size_t find_slot(
+    static uint32_t match_mask(
             uint32_t x, const uint32_t* restrict xs,
             uint32_t y, const uint32_t* restrict ys) noexcept
     {
-        for (std::size_t i = 0; i != N; ++i) {
-            if (UNLIKELY(x == xs[i] && y == ys[i])) {
-                return i;
-            }
-        }
-        return NO_SLOT;
+        const __m256i xneedle = _mm256_set1_epi32(static_cast<int>(x));
+        const __m256i yneedle = _mm256_set1_epi32(static_cast<int>(y));
+        auto match = [&](std::size_t i) {
+            return _mm256_and_si256(_mm256_cmpeq_epi32(xneedle, load(&xs[i])),
+                                    _mm256_cmpeq_epi32(yneedle, load(&ys[i])));
+        };
+        return to_mask(match(0 * STRIDE), match(1 * STRIDE), match(2 * STRIDE), match(3 * STRIDE));
+    }
+};
+
+} // namespace v2
+
+} // namespace gentbl
+
+#define GENTBL_V2_TABLE   TableAvx2
+#define GENTBL_V2_KERNELS Avx2Kernels
+#include "gentable_v2_impl.h"
+#undef GENTBL_V2_TABLE
+#undef GENTBL_V2_KERNELS
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+namespace gentbl {
+
+namespace v2 {
+
+// Two 16-slot compares straight into k-masks; the y compare is masked by
+// the x one, so a find is two loads, two compares and no narrowing.
+struct Avx512Kernels
+{
+    constexpr static Isa         ISA = Isa::Avx512;
+    constexpr static std::size_t STRIDE = 512 / 32;
+    constexpr static std::size_t ALIGN = 64;
+
+    static __m512i load(const uint32_t* p) noexcept
+    {
+        return _mm512_load_si512(p);
     }
 
-    static int count_slots(uint32_t x, const uint32_t* restrict xs) noexcept
+    static uint32_t match_mask(uint32_t x, const uint32_t* restrict xs) noexcept
     {
-        int result = 0;
-        for (std::size_t i = 0; i != N; ++i) {
-            if (x == xs[i]) {
-                ++result;
-            }
-        }
-        return result;
+        const __m512i needle = _mm512_set1_epi32(static_cast<int>(x));
+        return static_cast<uint32_t>(_mm512_cmpeq_epi32_mask(needle, load(&xs[0 * STRIDE]))) |
+               static_cast<uint32_t>(_mm512_cmpeq_epi32_mask(needle, load(&xs[1 * STRIDE]))) << 16;
+    }
+
+    static uint32_t match_mask(
+            uint32_t x, const uint32_t* restrict xs,
+            uint32_t y, const uint32_t* restrict ys) noexcept
+    {
+        const __m512i xneedle = _mm512_set1_epi32(static_cast<int>(x));
+        const __m512i yneedle = _mm512_set1_epi32(static_cast<int>(y));
+        auto match = [&](std::size_t i) {
+            return static_cast<uint32_t>(_mm512_mask_cmpeq_epi32_mask(
+                    _mm512_cmpeq_epi32_mask(xneedle, load(&xs[i])), yneedle, load(&ys[i])));
+        };
+        return match(0 * STRIDE) | match(1 * STRIDE) << 16;
     }
+};
+
+} // namespace v2
+
+} // namespace gentbl
+
+#define GENTBL_V2_TABLE   TableAvx512
+#define GENTBL_V2_KERNELS Avx512Kernels
+#include "gentable_v2_impl.h"
+#undef GENTBL_V2_TABLE
+#undef GENTBL_V2_KERNELS
+
+#pragma GCC pop_options
 
-    alignas(ALIGN) uint32_t xs[N] = { 0 };
-    alignas(ALIGN) uint32_t ys[N] = { 0 };
-    uint64_t zs[N] = { 0 };
+namespace gentbl {
+
+namespace v2 {
+
+// The widest variant the build flags allow, usable without a dispatch.
+#if defined(__AVX512F__)
+using Table = TableAvx512;
+#elif defined(__AVX2__)
+using Table = TableAvx2;
+#else
+using Table = TableSse2;
+#endif
+
+template <class T>
+struct type_tag
+{
+    using type = T;
 };
 
-} // namespace v1
+// Calls f(type_tag<TableXxx>{}) with the widest variant this CPU supports.
+template <class F>
+decltype(auto) dispatch(F&& f)
+{
+    switch (best_isa()) {
+    case Isa::Avx512: return f(type_tag<TableAvx512>{});
+    case Isa::Avx2:   return f(type_tag<TableAvx2>{});
+    case Isa::Sse2:   break;
+    }
+    return f(type_tag<TableSse2>{});
+}
+
+} // namespace v2
 
 } // namespace gentbl
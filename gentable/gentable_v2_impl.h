@@ -0,0 +1,83 @@
+// Body of the v2 table, written against a kernel struct with STRIDE, ALIGN,
+// ISA and the two match_mask overloads. Included once per instruction set by
+// gentable_v2.h, inside a `#pragma GCC target` region for that set, with
+// GENTBL_V2_TABLE and GENTBL_V2_KERNELS defined to the class names.
+#if !defined(GENTBL_V2_TABLE) || !defined(GENTBL_V2_KERNELS)
+#error "define GENTBL_V2_TABLE and GENTBL_V2_KERNELS before including gentable_v2_impl.h"
+#endif
+
+namespace gentbl {
+
+namespace v2 {
+
+struct GENTBL_V2_TABLE
+{
+public:
+    using Kernels = GENTBL_V2_KERNELS;
+    constexpr static std::size_t N = 32;
+    constexpr static std::size_t NO_SLOT = -1;
+    constexpr static uint64_t    INVALID = 0;
+    constexpr static Isa         ISA = Kernels::ISA;
+    constexpr static std::size_t STRIDE = Kernels::STRIDE;
+    constexpr static std::size_t ALIGN = Kernels::ALIGN;
+    static_assert((N % STRIDE) == 0);
+
+    static bool supported() noexcept { return best_isa() >= ISA; }
+
+    bool insert(uint32_t x, uint32_t y, uint64_t z) noexcept
+    {
+        // the occupancy of the last generation inserted into is kept in a
+        // register-sized mask, so back-to-back inserts don't each wait for
+        // the previous one's store to reload and compare xs
+        if (UNLIKELY(x != gen)) {
+            used = Kernels::match_mask(x, xs);
+            gen = x;
+        }
+        const uint32_t open = ~used;
+        if (LIKELY(open != 0)) {
+            const auto slot = static_cast<std::size_t>(__builtin_ctz(open));
+            used |= open & -open;
+            xs[slot] = x;
+            ys[slot] = y;
+            zs[slot] = z;
+            return true;
+        }
+        return false;
+    }
+
+    uint64_t find(uint32_t x, uint32_t y) const noexcept
+    {
+        const uint32_t found = Kernels::match_mask(x, xs, y, ys);
+        if (LIKELY(found == 0)) {
+            return INVALID;
+        }
+        return zs[__builtin_ctz(found)];
+    }
+
+    int size(uint32_t x) const noexcept
+    {
+        return __builtin_popcount(x == gen ? used : Kernels::match_mask(x, xs));
+    }
+
+    // TEMP TEMP
+    void dump(std::ostream& os)
+    {
+        fmt::print(os, "Table = {{\n");
+        for (std::size_t i = 0; i != N; ++i) {
+            fmt::print(os, "    {:08x} {:08x} {:016x}\n", xs[i], ys[i], zs[i]);
+        }
+        fmt::print(os, "}}\n");
+    }
+
+private:
+    alignas(ALIGN) uint32_t xs[N] = { 0 };
+    alignas(ALIGN) uint32_t ys[N] = { 0 };
+    uint64_t zs[N] = { 0 };
+    // slots of generation `gen`; every slot starts out in generation 0
+    uint32_t gen  = 0;
+    uint32_t used = ~0u;
+};
+
+} // namespace v2
+
+} // namespace gentbl
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <immintrin.h>
+#include "gentable_isa.h"
+
+
+// TODO: clean this up
+#define LIKELY(x)   __builtin_expect(!!(x), true)
+#define UNLIKELY(x) __builtin_expect(!!(x), false)
+#define restrict __restrict
+
+// The bucket compares are AVX2; the table is compiled for it whatever the
+// build flags, and can only be used where supported() says so.
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+namespace gentbl {
+
+namespace v3 {
+
+// Hashed array of 8-slot SIMD buckets for generations bigger than the 32
+// entries of v1/v2. The bucket is picked by a hash of y; a full bucket
+// spills into the next one. Every bucket carries the epoch it was last
+// written in, a private counter bumped at every change of generation, so
+// starting a new generation clears the table in O(1): stale buckets read as
+// empty and are reset on their first insert. Stamping with the epoch rather
+// than x keeps buckets from a generation id that comes back stale; only when
+// the counter wraps is the table really cleared.
+//
+// Unlike v1/v2 only the current generation (the last x inserted) is kept,
+// the same as STLTable, and inserting an existing y replaces its value.
+struct Table
+{
+public:
+    constexpr static std::size_t SLOTS   = 8;
+    constexpr static std::size_t NO_SLOT = -1;
+    constexpr static uint64_t    INVALID = 0;
+    constexpr static uint32_t    FULL    = (1u << SLOTS) - 1;
+
+    static bool supported() noexcept { return best_isa() >= Isa::Avx2; }
+
+    // room for `capacity` entries per generation at no more than half full
+    // buckets on average
+    explicit Table(std::size_t capacity)
+    {
+        std::size_t n = 1;
+        while (n * SLOTS / 2 < capacity) {
+            n *= 2;
+        }
+        nbuckets = n;
+        shift = 32;
+        for (; n > 1; n /= 2) {
+            --shift;
+        }
+        // zeroed buckets are empty buckets of epoch 0
+        buckets = std::make_unique<Bucket[]>(nbuckets);
+    }
+
+    bool insert(uint32_t x, uint32_t y, uint64_t z) noexcept
+    {
+        if (UNLIKELY(x != gen)) {
+            gen = x;
+            count = 0;
+            if (UNLIKELY(++epoch == 0)) {
+                clear();
+            }
+        }
+        for (std::size_t i = home(y), n = 0; n != nbuckets; i = (i + 1) & (nbuckets - 1), ++n) {
+            Bucket& b = buckets[i];
+            if (b.epoch != epoch) {
+                b.epoch = epoch;
+                b.used = 0;
+            }
+            const uint32_t found = b.match(y) & b.used;
+            if (UNLIKELY(found != 0)) {
+                b.zs[__builtin_ctz(found)] = z;
+                return true;
+            }
+            if (LIKELY(b.used != FULL)) {
+                const uint32_t open = ~b.used & FULL;
+                const auto slot = static_cast<std::size_t>(__builtin_ctz(open));
+                b.ys[slot] = y;
+                b.zs[slot] = z;
+                b.used |= open & -open;
+                ++count;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint64_t find(uint32_t x, uint32_t y) const noexcept
+    {
+        for (std::size_t i = home(y), n = 0; n != nbuckets; i = (i + 1) & (nbuckets - 1), ++n) {
+            const Bucket& b = buckets[i];
+            // stale buckets and other generations mask everything out
+            const uint32_t live = -static_cast<uint32_t>(b.epoch == epoch && x == gen);
+            const uint32_t used = b.used & live;
+            const uint32_t found = b.match(y) & used;
+            if (LIKELY(found != 0)) {
+                return b.zs[__builtin_ctz(found)];
+            }
+            if (LIKELY(used != FULL)) {
+                break;
+            }
+        }
+        return INVALID;
+    }
+
+    int size(uint32_t x) const noexcept
+    {
+        return x == gen ? static_cast<int>(count) : 0;
+    }
+
+    std::size_t bucket_count() const noexcept { return nbuckets; }
+
+private:
+    struct alignas(32) Bucket
+    {
+        uint32_t ys[SLOTS];
+        uint32_t epoch;
+        uint32_t used;
+        uint64_t zs[SLOTS];
+
+        // bit i set where ys[i] == y, occupied or not
+        uint32_t match(uint32_t y) const noexcept
+        {
+            const __m256i needle = _mm256_set1_epi32(static_cast<int>(y));
+            const __m256i haystk = _mm256_load_si256(reinterpret_cast<const __m256i*>(ys));
+            const __m256i result = _mm256_cmpeq_epi32(needle, haystk);
+            return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(result)));
+        }
+    };
+
+    // once the epoch wraps, buckets stamped 0 may be from any earlier
+    // generation
+    void clear() noexcept
+    {
+        for (std::size_t i = 0; i != nbuckets; ++i) {
+            buckets[i].epoch = 0;
+            buckets[i].used = 0;
+        }
+    }
+
+    // Fibonacci hashing: the top bits of y * 2^32/phi
+    std::size_t home(uint32_t y) const noexcept
+    {
+        return nbuckets == 1 ? 0 : static_cast<std::size_t>((y * 0x9e3779b9u) >> shift);
+    }
+
+    std::unique_ptr<Bucket[]> buckets;
+    std::size_t nbuckets;
+    unsigned shift;
+    uint32_t gen = 0;   // the x of the current generation
+    uint32_t epoch = 0; // stamp of the current generation's buckets
+    std::size_t count = 0;
+};
+
+} // namespace v3
+
+} // namespace gentbl
+
+#pragma GCC pop_options
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <immintrin.h>
+
+
+// TODO: clean this up
+#define LIKELY(x)   __builtin_expect(!!(x), true)
+#define UNLIKELY(x) __builtin_expect(!!(x), false)
+#define restrict __restrict
+
+namespace gentbl {
+
+namespace v4 {
+
+// v1 for one writer thread and any number of reader threads. The table is
+// guarded by a seqlock: insert() makes the sequence number odd, writes the
+// slot and makes it even again; find() and size() read the slots without
+// taking a lock and retry if the sequence number was odd or has changed
+// since they started. Readers never write shared memory and never allocate,
+// so they can't slow each other down or block the writer.
+//
+// Slots are relaxed atomics so the racy reads are well defined; on x86 they
+// are plain loads and stores, and the fences only stop compiler reordering.
+struct Table
+{
+public:
+    static constexpr std::size_t N       = 32;
+    static constexpr uint64_t    INVALID = 0;
+
+    // writer thread only
+    bool insert(uint32_t x, uint32_t y, uint64_t z) noexcept
+    {
+        // the writer is the only one changing xs, so it keeps a plain copy
+        // to scan and the occupancy of its current generation privately
+        if (UNLIKELY(x != gen)) {
+            used = 0;
+            for (std::size_t i = 0; i != N; ++i) {
+                used |= static_cast<uint32_t>(own_xs[i] == x) << i;
+            }
+            gen = x;
+        }
+        const uint32_t open = ~used;
+        if (UNLIKELY(open == 0)) {
+            return false;
+        }
+        const auto slot = static_cast<std::size_t>(__builtin_ctz(open));
+        used |= open & -open;
+        own_xs[slot] = x;
+
+        const uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        xs[slot].store(x, std::memory_order_relaxed);
+        ys[slot].store(y, std::memory_order_relaxed);
+        zs[slot].store(z, std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release);
+        return true;
+    }
+
+    uint64_t find(uint32_t x, uint32_t y) const noexcept
+    {
+        return read([&]() noexcept {
+            uint64_t z = INVALID;
+            for (std::size_t i = 0; i != N; ++i) {
+                if (UNLIKELY(xs[i].load(std::memory_order_relaxed) == x &&
+                             ys[i].load(std::memory_order_relaxed) == y)) {
+                    z = zs[i].load(std::memory_order_relaxed);
+                    break;
+                }
+            }
+            return z;
+        });
+    }
+
+    int size(uint32_t x) const noexcept
+    {
+        return read([&]() noexcept {
+            int result = 0;
+            for (std::size_t i = 0; i != N; ++i) {
+                result += xs[i].load(std::memory_order_relaxed) == x;
+            }
+            return result;
+        });
+    }
+
+private:
+    // run `f` until it saw no insert
+    template <class F>
+    auto read(F f) const noexcept -> decltype(f())
+    {
+        for (;;) {
+            const uint32_t s = seq.load(std::memory_order_acquire);
+            if (UNLIKELY(s & 1)) {
+                _mm_pause();
+                continue;
+            }
+            const auto result = f();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (LIKELY(seq.load(std::memory_order_relaxed) == s)) {
+                return result;
+            }
+        }
+    }
+
+    // readers only ever load the sequence number and the slots, so they
+    // share these lines with each other; the writer's private state is kept
+    // apart so updating it doesn't invalidate them
+    alignas(64) std::atomic<uint32_t> seq{0};
+    std::atomic<uint32_t> xs[N] = {};
+    std::atomic<uint32_t> ys[N] = {};
+    std::atomic<uint64_t> zs[N] = {};
+    alignas(64) uint32_t own_xs[N] = { 0 };
+    uint32_t gen  = 0;
+    uint32_t used = ~0u;
+};
+
+} // namespace v4
+
+} // namespace gentbl
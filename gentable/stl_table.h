@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+
+struct KeyEq
+{
+    uint32_t x, y;
+
+    constexpr KeyEq(uint32_t x_, uint32_t y_) noexcept : x(x_), y(y_) {}
+
+    friend constexpr bool operator==(KeyEq lhs, KeyEq rhs) noexcept
+    {
+        return lhs.x == rhs.x && lhs.y == rhs.y;
+    }
+
+    friend constexpr bool operator!=(KeyEq lhs, KeyEq rhs) noexcept
+    {
+        return !(lhs == rhs);
+    }
+};
+
+namespace std {
+
+template <> struct hash<KeyEq>
+{
+    std::size_t operator()(KeyEq k) const noexcept
+    {
+        uint64_t x = k.x;
+        uint64_t y = k.y;
+        return std::hash<uint64_t>()((x << 32) | y);
+    }
+};
+
+} // namespace std
+
+// std::unordered_map with the same interface as the gentables, keeping one
+// generation of at most `Cap` entries, as the reference in tests and
+// benchmarks; STLTable has the 32-entry cap of gentbl::v1::Table
+template <std::size_t Cap>
+struct BasicSTLTable
+{
+    bool insert(uint32_t x, uint32_t y, uint64_t z) noexcept
+    {
+        if (gen != x) {
+            gen = x;
+            t.clear();
+        }
+        if (t.size() >= Cap) {
+            return false;
+        }
+        t[y] = z;
+        return true;
+    }
+
+    uint64_t find(uint32_t x, uint32_t y) const noexcept
+    {
+        if (gen != x) {
+            return 0;
+        }
+        auto iter = t.find(y);
+        return iter == t.cend() ? 0 : iter->second;
+    }
+
+    int size(uint32_t x) const noexcept
+    {
+        return gen == x ? static_cast<int>(t.size()) : 0;
+    }
+
+    uint32_t gen = 0;
+    std::unordered_map<uint32_t, uint64_t> t = {};
+};
+
+using STLTable = BasicSTLTable<32>;
@@ -1,77 +1,38 @@
 #include <catch2/catch.hpp>
 #include "gentable_v1.h"
-#include <unordered_map>
+#include "gentable_v2.h"
+#include "gentable_v3.h"
+#include "gentable_v4.h"
+#include "stl_table.h"
+#include <atomic>
 #include <iostream>
+#include <random>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 #include <utility>
 
-struct KeyEq
+// tables for an instruction set this CPU lacks can't be run
+template <class T>
+static bool runnable()
 {
-    uint32_t x, y;
-
-    constexpr KeyEq(uint32_t x_, uint32_t y_) noexcept : x(x_), y(y_) {}
-
-    friend constexpr bool operator==(KeyEq lhs, KeyEq rhs) noexcept
-    {
-        return lhs.x == rhs.x && lhs.y == rhs.y;
-    }
-
-    friend constexpr bool operator!=(KeyEq lhs, KeyEq rhs) noexcept
-    {
-        return !(lhs == rhs);
-    }
-};
-
-namespace std {
-
-template <> struct hash<KeyEq>
-{
-    std::size_t operator()(KeyEq k) const noexcept
-    {
-        uint64_t x = k.x;
-        uint64_t y = k.y;
-        return std::hash<uint64_t>()((x << 32) | y);
-    }
-};
-
-} // namespace std
-
-struct STLTable
-{
-    bool insert(uint32_t x, uint32_t y, uint64_t z) noexcept
-    {
-        if (gen != x) {
-            gen = x;
-            t.clear();
-        }
-        if (t.size() >= 32) {
-            return false;
-        }
-        t[y] = z;
+    if constexpr (std::is_same_v<T, gentbl::v1::Table> || std::is_same_v<T, gentbl::v4::Table>) {
         return true;
+    } else {
+        return T::supported();
     }
+}
 
-    uint64_t find(uint32_t x, uint32_t y) const noexcept
-    {
-        if (gen != x) {
-            return 0;
-        }
-        auto iter = t.find(y);
-        return iter == t.cend() ? 0 : iter->second;
-    }
-
-    int size(uint32_t x) const noexcept
-    {
-        return static_cast<int>(t.size());
-    }
-
-    uint32_t gen = 0;
-    std::unordered_map<uint32_t, uint64_t> t = {};
-};
-
-TEST_CASE("Insert up to 32 values with same x", "[gentbl]")
+TEMPLATE_TEST_CASE("Insert up to 32 values with same x", "[gentbl]",
+                   gentbl::v1::Table, gentbl::v2::TableSse2,
+                   gentbl::v2::TableAvx2, gentbl::v2::TableAvx512,
+                   gentbl::v4::Table)
 {
-    gentbl::v1::Table t;
+    if (!runnable<TestType>()) {
+        return;
+    }
+    TestType t;
     const std::vector<uint32_t> keys = {
         1,
         2,
@@ -169,7 +130,7 @@ TEST_CASE("Insert random values and look them up", "[gentbl]")
         0x6650602f, 0x59b34aad, 0x8a0132a1, 0x59c23517,
     };
 
-    auto RunTest = [&](auto t)
+    auto RunTest = [&](auto& t)
     {
         for (const auto x : keys) {
             for (auto&& [y, z] : vals) {
@@ -203,4 +164,183 @@ TEST_CASE("Insert random values and look them up", "[gentbl]")
         gentbl::v1::Table t;
         RunTest(t);
     }
+
+    SECTION("Table v2")
+    {
+        gentbl::v2::Table t;
+        RunTest(t);
+    }
+
+    SECTION("Table v4")
+    {
+        gentbl::v4::Table t;
+        RunTest(t);
+    }
+
+    SECTION("Table v2, dispatched")
+    {
+        gentbl::v2::dispatch([&](auto tag) {
+            typename decltype(tag)::type t;
+            RunTest(t);
+        });
+    }
+}
+
+// v1 keeps entries of every x it has room for, v3 only the last x's, so
+// each is checked against the reference with the same semantics
+template <class T>
+struct Reference { using type = gentbl::v1::Table; };
+
+template <>
+struct Reference<gentbl::v3::Table> { using type = BasicSTLTable<64>; };
+
+template <class T>
+static T make_table()
+{
+    if constexpr (std::is_same_v<T, gentbl::v3::Table>) {
+        return T(64);
+    } else {
+        return T{};
+    }
+}
+
+TEMPLATE_TEST_CASE("Tables match their reference when generations interleave", "[gentbl]",
+                   gentbl::v2::TableSse2, gentbl::v2::TableAvx2,
+                   gentbl::v2::TableAvx512, gentbl::v3::Table, gentbl::v4::Table)
+{
+    if (!runnable<TestType>()) {
+        return;
+    }
+    typename Reference<TestType>::type t1;
+    TestType t2 = make_table<TestType>();
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<uint32_t> x(1, 4);
+    std::uniform_int_distribution<uint32_t> y(1, 64);
+
+    for (int i = 0; i < 10000; ++i) {
+        const uint32_t xi = x(gen);
+        const uint32_t yi = y(gen);
+        CHECK(t1.insert(xi, yi, i + 1u) == t2.insert(xi, yi, i + 1u));
+        const uint32_t xj = x(gen);
+        CHECK(t1.size(xj) == t2.size(xj));
+        CHECK(t1.find(xj, yi) == t2.find(xj, yi));
+    }
+}
+
+TEST_CASE("v3 forgets a generation whose x comes back", "[gentbl]")
+{
+    if (!gentbl::v3::Table::supported()) {
+        return;
+    }
+    gentbl::v3::Table t(64);
+    STLTable ref;
+    for (auto [x, y, z] : { std::tuple{1u, 10u, 100u}, {2u, 20u, 200u}, {1u, 30u, 300u} }) {
+        CHECK(t.insert(x, y, z) == ref.insert(x, y, z));
+    }
+    CHECK(t.find(1, 10) == ref.find(1, 10));
+    CHECK(t.find(1, 10) == 0);
+    CHECK(t.find(1, 30) == 300);
+    CHECK(t.size(1) == 1);
+}
+
+TEST_CASE("v2 dispatches to the widest supported variant", "[gentbl]")
+{
+    using gentbl::Isa;
+    const Isa isa = gentbl::v2::dispatch([](auto tag) { return decltype(tag)::type::ISA; });
+    CHECK(isa == gentbl::best_isa());
+    CHECK(gentbl::v2::TableSse2::supported());
+    CHECK(gentbl::v2::TableAvx512::supported() == (isa == Isa::Avx512));
+    CHECK(gentbl::v2::TableAvx2::STRIDE == 8);
+    CHECK(gentbl::v2::TableAvx512::ALIGN == 64);
+}
+
+TEST_CASE("v4 readers never see a torn entry", "[gentbl]")
+{
+    // every z is derived from its x and y, so a reader that mixed up slots
+    // or caught one half written would find a z that doesn't match
+    auto value = [](uint32_t x, uint32_t y) { return (uint64_t{x} << 32) | y; };
+    gentbl::v4::Table t;
+    std::atomic<bool> done{false};
+    std::atomic<int> bad{0};
+    std::vector<std::thread> readers;
+
+    for (int r = 0; r < 3; ++r) {
+        readers.emplace_back([&, r] {
+            std::mt19937 gen(static_cast<unsigned>(r));
+            std::uniform_int_distribution<uint32_t> x(1, 8);
+            std::uniform_int_distribution<uint32_t> y(1, 40);
+            while (!done.load(std::memory_order_relaxed)) {
+                const uint32_t xi = x(gen);
+                const uint32_t yi = y(gen);
+                const uint64_t z = t.find(xi, yi);
+                const int n = t.size(xi);
+                if ((z != 0 && z != value(xi, yi)) || n < 0 || n > 32) {
+                    bad.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+        });
+    }
+    for (int round = 0; round < 2000; ++round) {
+        const uint32_t x = static_cast<uint32_t>(round % 8) + 1;
+        const uint32_t y0 = static_cast<uint32_t>(round % 9);
+        for (uint32_t y = y0 + 1; y <= y0 + 32; ++y) {
+            t.insert(x, y, value(x, y));
+        }
+        if (round % 64 == 0) {
+            std::this_thread::yield();
+        }
+    }
+    done = true;
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    CHECK(bad == 0);
+}
+
+TEST_CASE("v3 holds whole generations", "[gentbl]")
+{
+    if (!gentbl::v3::Table::supported()) {
+        return;
+    }
+    std::mt19937 gen(42);
+
+    for (std::size_t n : { 1u, 32u, 1000u, 65536u }) {
+        gentbl::v3::Table t(n);
+        BasicSTLTable<std::size_t(-1)> ref;
+        std::uniform_int_distribution<uint32_t> y(1, static_cast<uint32_t>(2 * n));
+
+        for (uint32_t x = 1; x <= 3; ++x) {
+            for (std::size_t i = 0; i < n; ++i) {
+                const uint32_t yi = y(gen);
+                const uint64_t z = gen() | 1u;
+                REQUIRE(t.insert(x, yi, z) == ref.insert(x, yi, z));
+            }
+            CHECK(t.size(x) == ref.size(x));
+            CHECK(t.size(x - 1) == 0);
+            for (uint32_t yi = 1; yi <= 2 * n; ++yi) {
+                REQUIRE(t.find(x, yi) == ref.find(x, yi));
+                REQUIRE(t.find(x + 1, yi) == 0);
+            }
+        }
+    }
+}
+
+TEST_CASE("v3 refuses inserts once every bucket is full", "[gentbl]")
+{
+    if (!gentbl::v3::Table::supported()) {
+        return;
+    }
+    gentbl::v3::Table t(1);
+    const auto cap = t.bucket_count() * gentbl::v3::Table::SLOTS;
+
+    for (uint32_t y = 1; y <= cap; ++y) {
+        CHECK(t.insert(7, y, y));
+    }
+    CHECK(t.insert(7, 1, 42));
+    CHECK(t.find(7, 1) == 42);
+    CHECK_FALSE(t.insert(7, cap + 1, 1));
+    CHECK(t.size(7) == static_cast<int>(cap));
+    CHECK(t.insert(8, cap + 1, 1));
+    CHECK(t.size(8) == 1);
+    CHECK(t.find(7, 2) == 0);
 }
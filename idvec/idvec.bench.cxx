@@ -0,0 +1,176 @@
+#include <benchmark/benchmark.h>
+#include <stdexcept>
+
+#include "idvec.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// IdMap against the two usual stand-ins for a dense id -> value map, with ids
+// handed out densely from 0 and `density` percent of them live.
+
+using Id = uint32_t;
+
+struct Session
+{
+    uint64_t seqnum;
+    uint32_t gateway;
+    uint32_t flags;
+};
+
+using HashMap     = std::unordered_map<Id, Session>;
+using OptionalVec = std::vector<std::optional<Session>>;
+using DenseMap    = IdMap<Id, Session>;
+
+void MapInsert(HashMap& m, Id id, const Session& s) { m.insert_or_assign(id, s); }
+void MapInsert(DenseMap& m, Id id, const Session& s) { m.insert(id, s); }
+void MapInsert(OptionalVec& m, Id id, const Session& s)
+{
+    if (!(id < m.size())) {
+        m.resize(id + 1);
+    }
+    m[id].emplace(s);
+}
+
+const Session* MapFind(const HashMap& m, Id id)
+{
+    auto it = m.find(id);
+    return it != m.end() ? &it->second : nullptr;
+}
+const Session* MapFind(const DenseMap& m, Id id) { return m.find(id); }
+const Session* MapFind(const OptionalVec& m, Id id)
+{
+    return id < m.size() && m[id] ? &*m[id] : nullptr;
+}
+
+uint64_t MapSum(const HashMap& m)
+{
+    uint64_t sum = 0;
+    for (auto&& [id, s] : m) {
+        sum += s.seqnum;
+    }
+    return sum;
+}
+uint64_t MapSum(const DenseMap& m)
+{
+    uint64_t sum = 0;
+    for (auto&& [id, s] : m) {
+        sum += s.seqnum;
+    }
+    return sum;
+}
+uint64_t MapSum(const OptionalVec& m)
+{
+    uint64_t sum = 0;
+    for (auto&& s : m) {
+        if (s) {
+            sum += s->seqnum;
+        }
+    }
+    return sum;
+}
+
+static std::vector<Id> MakeIds(std::size_t n, int density)
+{
+    std::mt19937_64 gen(42);
+    std::vector<Id> ids;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (static_cast<int>(gen() % 100) < density) {
+            ids.push_back(static_cast<Id>(i));
+        }
+    }
+    std::shuffle(ids.begin(), ids.end(), gen);
+    return ids;
+}
+
+template <class Map>
+static Map MakeMap(const std::vector<Id>& ids)
+{
+    Map m;
+    for (auto id : ids) {
+        MapInsert(m, id, Session{id, id % 16, 0});
+    }
+    return m;
+}
+
+// building the map from scratch, in random id order
+template <class Map>
+static void BM_Insert(benchmark::State& state)
+{
+    const auto ids = MakeIds(static_cast<std::size_t>(state.range(0)),
+                             static_cast<int>(state.range(1)));
+
+    for (auto _ : state) {
+        auto m = MakeMap<Map>(ids);
+        benchmark::DoNotOptimize(MapFind(m, ids[0]));
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ids.size()));
+}
+
+// looking up random ids, live or not, and reading the live ones
+template <class Map>
+static void BM_Find(benchmark::State& state)
+{
+    const auto n = static_cast<std::size_t>(state.range(0));
+    const auto m = MakeMap<Map>(MakeIds(n, static_cast<int>(state.range(1))));
+    std::vector<Id> lookups;
+    std::mt19937_64 gen(7);
+    for (std::size_t i = 0; i < 4096; ++i) {
+        lookups.push_back(static_cast<Id>(gen() % n));
+    }
+    uint64_t sum = 0;
+
+    for (auto _ : state) {
+        for (auto id : lookups) {
+            if (const Session* s = MapFind(m, id)) {
+                sum += s->seqnum;
+            }
+        }
+    }
+
+    if (sum == 0) {
+        throw std::runtime_error("invalid!");
+    }
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(lookups.size()));
+}
+
+// visiting every live value
+template <class Map>
+static void BM_Iterate(benchmark::State& state)
+{
+    const auto ids = MakeIds(static_cast<std::size_t>(state.range(0)),
+                             static_cast<int>(state.range(1)));
+    const auto m = MakeMap<Map>(ids);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(MapSum(m));
+    }
+
+    state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(ids.size()));
+}
+
+static void SizesAndDensities(benchmark::internal::Benchmark* b)
+{
+    for (int64_t n : { 1<<10, 64<<10, 1<<20 }) {
+        for (int64_t density : { 10, 50, 100 }) {
+            b->Args({n, density});
+        }
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_Insert, HashMap)->Apply(SizesAndDensities);
+BENCHMARK_TEMPLATE(BM_Insert, OptionalVec)->Apply(SizesAndDensities);
+BENCHMARK_TEMPLATE(BM_Insert, DenseMap)->Apply(SizesAndDensities);
+BENCHMARK_TEMPLATE(BM_Find, HashMap)->Apply(SizesAndDensities);
+BENCHMARK_TEMPLATE(BM_Find, OptionalVec)->Apply(SizesAndDensities);
+BENCHMARK_TEMPLATE(BM_Find, DenseMap)->Apply(SizesAndDensities);
+BENCHMARK_TEMPLATE(BM_Iterate, HashMap)->Apply(SizesAndDensities);
+BENCHMARK_TEMPLATE(BM_Iterate, OptionalVec)->Apply(SizesAndDensities);
+BENCHMARK_TEMPLATE(BM_Iterate, DenseMap)->Apply(SizesAndDensities);
+
+BENCHMARK_MAIN();
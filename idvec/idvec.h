@@ -1,10 +1,25 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <malloc.h>
 
-
+// Dense map from small integer ids to values: the value for id `i` lives in
+// slot `i` of one array and a bitmap records which slots hold a value, so
+// lookups are an index and a bit test. Ids should be (mostly) dense from 0,
+// as the array is as long as the largest id inserted.
 template <class Id, class Value>
 class IdMap
 {
+public:
     using key_type    = Id;
     using mapped_type = Value;
     using index_type  = std::size_t;
@@ -14,72 +29,308 @@ class IdMap
             "IdMap only supports nothrow move constructible type");
     static_assert(std::is_convertible_v<Id, index_type>,
             "Must be able to convert Id type to index_type");
-    static_assert(std::is_default_constructible_v<Value>);
+    static_assert(std::is_constructible_v<Id, index_type>,
+            "Must be able to construct Id type from index_type");
+    static_assert(alignof(Value) <= alignof(std::max_align_t),
+            "IdMap allocates with malloc");
+
+    // Values that are trivially copyable are also trivially relocatable, so
+    // they can be moved by realloc()
+    static constexpr bool relocatable = std::is_trivially_copyable_v<Value>;
 
     IdMap() noexcept = default;
-    // IdMap(std::size_t n_slots) noexcept
+
+    explicit IdMap(size_type n_slots)
+    {
+        reserve(n_slots);
+    }
+
+    IdMap(const IdMap& other) : IdMap()
+    {
+        reserve(other.m_slots);
+        other.for_each_index([&](index_type index) {
+            new (&m_values[index]) Value(other.m_values[index]);
+            set_present(index);
+            ++m_count;
+        });
+    }
+
+    IdMap(IdMap&& other) noexcept
+        : m_values{std::exchange(other.m_values, nullptr)}
+        , m_present{std::exchange(other.m_present, nullptr)}
+        , m_slots{std::exchange(other.m_slots, 0)}
+        , m_count{std::exchange(other.m_count, 0)}
+    {
+    }
+
+    IdMap& operator=(const IdMap& other)
+    {
+        if (this != &other) {
+            IdMap copy{other};
+            swap(copy);
+        }
+        return *this;
+    }
+
+    IdMap& operator=(IdMap&& other) noexcept
+    {
+        IdMap tmp{std::move(other)};
+        swap(tmp);
+        return *this;
+    }
+
+    ~IdMap() noexcept
+    {
+        clear();
+        free(m_values);
+        free(m_present);
+    }
+
+    void swap(IdMap& other) noexcept
+    {
+        std::swap(m_values,  other.m_values);
+        std::swap(m_present, other.m_present);
+        std::swap(m_slots,   other.m_slots);
+        std::swap(m_count,   other.m_count);
+    }
 
     template <class F>
     Value& get_or_assign(Id id, F&& or_else)
     {
         const auto index = static_cast<index_type>(id);
-        if (!(index < size())) {
-            grow(index + 1);
-            new (&m_begin[index]) Value{or_else()};
+        if (!contains(id)) {
+            emplace_at(index, or_else());
         }
-        return get(id);
+        return m_values[index];
     }
 
-    Value& get(Id id) const noexcept
+    // replaces the value if `id` is already present
+    template <class... Args>
+    Value& insert(Id id, Args&&... args)
     {
         const auto index = static_cast<index_type>(id);
-        assert(index < size());
-        return m_begin[index];
+        if (contains(id)) {
+            // construct first, so a throw leaves the old value in place
+            Value value{std::forward<Args>(args)...};
+            std::destroy_at(&m_values[index]);
+            new (&m_values[index]) Value(std::move(value));
+            return m_values[index];
+        }
+        return emplace_at(index, std::forward<Args>(args)...);
     }
 
-    template <class... Args>
-    Value& insert(Id id, Args&&... args)
+    // returns true if `id` was present
+    bool erase(Id id) noexcept
     {
         const auto index = static_cast<index_type>(id);
-        if (!(index < size())) {
-            grow(index + 1);
+        if (!contains(id)) {
+            return false;
         }
-        new (&m_begin[index]) Value{std::forward<Args>(args)...};
-        return get(index);
+        std::destroy_at(&m_values[index]);
+        m_present[index / 64] &= ~bit(index);
+        --m_count;
+        return true;
     }
 
-    // jmp::Optional<Value> get(Id id) const
-    // {
-    // }
+    bool contains(Id id) const noexcept
+    {
+        const auto index = static_cast<index_type>(id);
+        return index < m_slots && (m_present[index / 64] & bit(index)) != 0;
+    }
 
-    size_type size() const noexcept
+    Value& get(Id id) const noexcept
+    {
+        assert(contains(id));
+        return m_values[static_cast<index_type>(id)];
+    }
+
+    // nullptr if `id` isn't present
+    Value* find(Id id) const noexcept
     {
-        return m_end - m_begin;
+        return contains(id) ? &m_values[static_cast<index_type>(id)] : nullptr;
     }
 
-    size_type capacity() const noexcept
+    void clear() noexcept
     {
-        return m_capacity - m_begin;
+        if constexpr (!std::is_trivially_destructible_v<Value>) {
+            for_each_index([&](index_type index) { std::destroy_at(&m_values[index]); });
+        }
+        if (m_present) {
+            memset(m_present, 0, words(m_slots) * sizeof(*m_present));
+        }
+        m_count = 0;
     }
 
+    // make room for ids up to `n_slots - 1`
+    void reserve(size_type n_slots)
+    {
+        if (n_slots > m_slots) {
+            grow(n_slots);
+        }
+    }
+
+    size_type size()     const noexcept { return m_count; }
+    bool      empty()    const noexcept { return m_count == 0; }
+    size_type capacity() const noexcept { return m_slots; }
+
+    // Iterates the ids present in increasing order, dereferencing to
+    // (id, value&). The iterator keeps the rest of the current bitmap word,
+    // so erasing the id it's at is fine but other inserts and erases
+    // invalidate it.
+    template <bool Const>
+    class basic_iterator
+    {
+    public:
+        using map_type   = std::conditional_t<Const, const IdMap, IdMap>;
+        using value_ref  = std::conditional_t<Const, const Value&, Value&>;
+        using reference  = std::pair<Id, value_ref>;
+        using value_type = reference;
+        using difference_type   = std::ptrdiff_t;
+        using iterator_category = std::forward_iterator_tag;
+
+        basic_iterator(map_type* map, size_type word) noexcept
+            : m_map{map}, m_word{word}, m_bits{0}
+        {
+            skip_empty_words();
+        }
+
+        reference operator*() const noexcept
+        {
+            const auto index = index_type{m_word * 64 + __builtin_ctzll(m_bits)};
+            return reference{static_cast<Id>(index), m_map->m_values[index]};
+        }
+
+        basic_iterator& operator++() noexcept
+        {
+            m_bits &= m_bits - 1;
+            if (m_bits == 0) {
+                ++m_word;
+                skip_empty_words();
+            }
+            return *this;
+        }
+
+        basic_iterator operator++(int) noexcept
+        {
+            auto result = *this;
+            ++*this;
+            return result;
+        }
+
+        bool operator==(const basic_iterator& other) const noexcept
+        {
+            return m_word == other.m_word && m_bits == other.m_bits;
+        }
+
+        bool operator!=(const basic_iterator& other) const noexcept
+        {
+            return !(*this == other);
+        }
+
+    private:
+        void skip_empty_words() noexcept
+        {
+            const auto n_words = words(m_map->m_slots);
+            for (; m_word < n_words; ++m_word) {
+                if ((m_bits = m_map->m_present[m_word]) != 0) {
+                    return;
+                }
+            }
+            m_word = n_words;
+        }
+
+        map_type* m_map;
+        size_type m_word; // index of the current bitmap word
+        uint64_t  m_bits; // the bits of it not visited yet
+    };
+
+    using iterator       = basic_iterator<false>;
+    using const_iterator = basic_iterator<true>;
+
+    iterator       begin()       noexcept { return iterator{this, 0}; }
+    iterator       end()         noexcept { return iterator{this, words(m_slots)}; }
+    const_iterator begin() const noexcept { return const_iterator{this, 0}; }
+    const_iterator end()   const noexcept { return const_iterator{this, words(m_slots)}; }
+
 private:
-    void grow(std::size_t minsize) noexcept
-    {
-        const auto cursize = size();
-        const auto newcapacity = std::max(minsize, (capacity() + 1) * 1.5);
-        assert(newcapacity > capacity());
-        // TODO: check malloc_usable_size
-        // TODO: use reallocarrary if Value is trivial
-        auto* begin = static_cast<Value*>(calloc(cursize, sizeof(Value)));
-        assert(begin != nullptr); // TODO: decide if going to throw std::bad_alloc{}
-        std::uninitialized_move_n(m_begin, cursize, begin);
-        m_begin    = begin;
-        m_end      = begin + cursize;
-        m_capacity = begin + newcapacity;
-    }
-
-    // TODO: add small vector optimization
-    Value* m_begin = nullptr;
-    Value* m_end = nullptr;
-    Value* m_capacity = nullptr;
+    static constexpr uint64_t bit(index_type index) noexcept
+    {
+        return uint64_t{1} << (index % 64);
+    }
+
+    static constexpr size_type words(size_type n_slots) noexcept
+    {
+        return (n_slots + 63) / 64;
+    }
+
+    void set_present(index_type index) noexcept
+    {
+        m_present[index / 64] |= bit(index);
+    }
+
+    template <class F>
+    void for_each_index(F&& f) const
+    {
+        for (size_type w = 0, n_words = words(m_slots); w < n_words; ++w) {
+            for (auto bits = m_present[w]; bits != 0; bits &= bits - 1) {
+                f(w * 64 + static_cast<index_type>(__builtin_ctzll(bits)));
+            }
+        }
+    }
+
+    template <class... Args>
+    Value& emplace_at(index_type index, Args&&... args)
+    {
+        if (!(index < m_slots)) {
+            grow(index + 1);
+        }
+        new (&m_values[index]) Value{std::forward<Args>(args)...};
+        set_present(index);
+        ++m_count;
+        return m_values[index];
+    }
+
+    void grow(size_type minsize)
+    {
+        auto want = std::max<size_type>({minsize, m_slots + m_slots / 2, 16u});
+        Value* values;
+        if constexpr (relocatable) {
+            values = static_cast<Value*>(reallocarray(m_values, want, sizeof(Value)));
+            if (!values) {
+                throw std::bad_alloc{};
+            }
+            // use whatever slack the allocator gave us
+            want = std::max(want, malloc_usable_size(values) / sizeof(Value));
+        } else {
+            values = static_cast<Value*>(reallocarray(nullptr, want, sizeof(Value)));
+            if (!values) {
+                throw std::bad_alloc{};
+            }
+            for_each_index([&](index_type index) {
+                new (&values[index]) Value(std::move(m_values[index]));
+                std::destroy_at(&m_values[index]);
+            });
+            free(m_values);
+        }
+        m_values = values;
+
+        const auto have_words = words(m_slots);
+        const auto want_words = words(want);
+        if (want_words > have_words) {
+            auto* present = static_cast<uint64_t*>(reallocarray(m_present, want_words, sizeof(uint64_t)));
+            if (!present) {
+                // the values have moved already, but the slot count is
+                // unchanged so the map is still consistent
+                throw std::bad_alloc{};
+            }
+            memset(present + have_words, 0, (want_words - have_words) * sizeof(uint64_t));
+            m_present = present;
+        }
+        m_slots = want;
+    }
+
+    Value*    m_values  = nullptr;
+    uint64_t* m_present = nullptr; // bit `i` set if slot `i` holds a value
+    size_type m_slots   = 0;
+    size_type m_count   = 0;
 };
@@ -2,6 +2,8 @@
 #include "idvec.h"
 
 #include "small_vector.h"
+#include <string>
+#include <vector>
 
 struct GatewayId
 {
@@ -17,6 +19,92 @@ TEST_CASE("IdMap")
 {
     auto id = GatewayId{42};
     CHECK(id == 42u);
+
+    IdMap<GatewayId, int> m;
+    CHECK(m.empty());
+    CHECK(!m.contains(id));
+    CHECK(m.find(id) == nullptr);
+    CHECK(m.begin() == m.end());
+
+    m.insert(id, 1);
+    CHECK(m.size() == 1u);
+    CHECK(m.capacity() > 42u);
+    CHECK(m.contains(id));
+    CHECK(m.get(id) == 1);
+    // the gaps below 42 don't hold values
+    CHECK(!m.contains(GatewayId{0}));
+    CHECK(!m.contains(GatewayId{41}));
+
+    m.insert(id, 2);
+    CHECK(m.size() == 1u);
+    CHECK(m.get(id) == 2);
+
+    CHECK(m.get_or_assign(GatewayId{3}, [] { return 3; }) == 3);
+    CHECK(m.get_or_assign(GatewayId{3}, [] { return 4; }) == 3);
+    CHECK(m.size() == 2u);
+
+    // ids far past the capacity, across several bitmap words
+    m.insert(GatewayId{1000}, 1000);
+    CHECK(m.size() == 3u);
+    CHECK(m.get(id) == 2);
+    CHECK(m.get(GatewayId{3}) == 3);
+    CHECK(*m.find(GatewayId{1000}) == 1000);
+
+    std::vector<unsigned> ids;
+    for (auto [i, v] : m) {
+        ids.push_back(i);
+        v += 1;
+    }
+    CHECK(ids == std::vector<unsigned>{3, 42, 1000});
+    CHECK(m.get(GatewayId{3}) == 4);
+
+    CHECK(m.erase(id));
+    CHECK(!m.erase(id));
+    CHECK(!m.erase(GatewayId{5000}));
+    CHECK(!m.contains(id));
+    CHECK(m.size() == 2u);
+
+    m.clear();
+    CHECK(m.empty());
+    CHECK(m.begin() == m.end());
+}
+
+TEST_CASE("IdMap with values that aren't trivially copyable")
+{
+    IdMap<unsigned, std::string> m(8);
+    CHECK(m.capacity() >= 8u);
+
+    const std::size_t N = 1000;
+    for (unsigned i = 0; i < N; i += 3) {
+        m.insert(i, "value for a sparse id " + std::to_string(i));
+    }
+    CHECK(m.size() == (N + 2) / 3);
+    for (unsigned i = 0; i < N; ++i) {
+        REQUIRE(m.contains(i) == (i % 3 == 0));
+    }
+    CHECK(m.get(999) == "value for a sparse id 999");
+
+    auto copy = m;
+    for (unsigned i = 0; i < N; i += 6) {
+        CHECK(copy.erase(i));
+    }
+    CHECK(copy.size() == m.size() / 2);
+    CHECK(m.get(6) == "value for a sparse id 6");
+
+    const auto& cm = copy;
+    std::size_t n = 0;
+    for (auto [i, v] : cm) {
+        CHECK(i % 6 == 3);
+        CHECK(v == "value for a sparse id " + std::to_string(i));
+        ++n;
+    }
+    CHECK(n == copy.size());
+
+    auto moved = std::move(copy);
+    CHECK(copy.empty());
+    CHECK(moved.size() == n);
+    moved = m;
+    CHECK(moved.size() == m.size());
 }
 
 TEST_CASE("SmallVector")
@@ -45,4 +133,97 @@ TEST_CASE("SmallVector")
     CHECK(v.empty());
 }
 
-// TODO: test resize()
+TEST_CASE("SmallVector keeps N elements inline")
+{
+    SmallVector<int, 4> v;
+    CHECK(v.is_inline());
+    CHECK(v.capacity() == 4u);
+    for (int i = 0; i < 4; ++i) {
+        v.push_back(i);
+    }
+    CHECK(v.is_inline());
+
+    v.push_back(4);
+    CHECK(!v.is_inline());
+    CHECK(v.capacity() >= 5u);
+    for (int i = 0; i < 100; ++i) {
+        // an element of itself, across the reallocations
+        v.push_back(v[i]);
+    }
+    REQUIRE(v.size() == 105u);
+    for (int i = 0; i < 105; ++i) {
+        REQUIRE(v[i] == (i < 5 ? i : v[i - 5]));
+    }
+
+    // clear keeps the capacity
+    const auto cap = v.capacity();
+    v.clear();
+    CHECK(v.empty());
+    CHECK(v.capacity() == cap);
+
+    SmallVector<int, 4> u;
+    u.push_back(7);
+    SmallVector<int, 4> w = std::move(u);
+    CHECK(w.is_inline());
+    CHECK(w.size() == 1u);
+    CHECK(w[0] == 7);
+    CHECK(u.empty());
+}
+
+TEST_CASE("SmallVector resize()")
+{
+    SmallVector<int, 2> v;
+    v.resize(3);
+    CHECK(v.size() == 3u);
+    CHECK(v[0] == 0);
+    CHECK(v[2] == 0);
+    v.resize(5, 42);
+    CHECK(v.size() == 5u);
+    CHECK(v[2] == 0);
+    CHECK(v[3] == 42);
+    CHECK(v[4] == 42);
+    v.resize(1);
+    CHECK(v.size() == 1u);
+    CHECK(v.back() == 0);
+}
+
+TEST_CASE("SmallVector with elements that aren't trivially relocatable")
+{
+    using Vec = SmallVector<std::string, 2>;
+    static_assert(!Vec::relocatable);
+
+    const auto make = [](int i) {
+        return "a string too long for std::string's own SSO " + std::to_string(i);
+    };
+
+    Vec v;
+    v.emplace_back(make(0));
+    Vec inline_copy = v;
+    CHECK(inline_copy.is_inline());
+    CHECK(inline_copy[0] == make(0));
+
+    for (int i = 1; i < 50; ++i) {
+        v.push_back(make(i));
+    }
+    v.push_back(v.front());
+    REQUIRE(v.size() == 51u);
+    CHECK(v.back() == make(0));
+
+    Vec copy = v;
+    Vec moved = std::move(v);
+    CHECK(v.empty());
+    CHECK(v.is_inline());
+    REQUIRE(moved.size() == 51u);
+    for (int i = 0; i < 50; ++i) {
+        CHECK(moved[i] == make(i));
+        CHECK(copy[i] == make(i));
+    }
+
+    moved = inline_copy;
+    CHECK(moved.size() == 1u);
+    copy = std::move(inline_copy);
+    CHECK(copy.size() == 1u);
+    CHECK(copy[0] == make(0));
+    moved.pop_back();
+    CHECK(moved.empty());
+}
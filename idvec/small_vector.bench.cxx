@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+#include <stdexcept>
+
+#include "small_vector.h"
+
+#include <cstdint>
+#include <vector>
+
+// The usual small vector workload: a handful of elements pushed onto a
+// temporary that is then thrown away, where std::vector pays a malloc and
+// free (and a few reallocations) every time.
+
+using StdVector   = std::vector<int>;
+using SmallVec8   = SmallVector<int, 8>;
+using SmallVec16  = SmallVector<int, 16>;
+
+template <class Vec>
+static void BM_PushThenDiscard(benchmark::State& state)
+{
+    const auto n = static_cast<int>(state.range(0));
+    int64_t sum = 0;
+
+    for (auto _ : state) {
+        Vec v;
+        for (int i = 0; i < n; ++i) {
+            v.push_back(i);
+        }
+        benchmark::DoNotOptimize(v.data());
+        sum += static_cast<int64_t>(v.size());
+    }
+
+    if (sum != state.iterations() * n) {
+        throw std::runtime_error("invalid!");
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+static void SmallSizes(benchmark::internal::Benchmark* b)
+{
+    for (int64_t n : { 0, 1, 4, 8, 12, 16 }) {
+        b->Arg(n);
+    }
+}
+
+BENCHMARK_TEMPLATE(BM_PushThenDiscard, StdVector)->Apply(SmallSizes);
+BENCHMARK_TEMPLATE(BM_PushThenDiscard, SmallVec8)->Apply(SmallSizes);
+BENCHMARK_TEMPLATE(BM_PushThenDiscard, SmallVec16)->Apply(SmallSizes);
+
+// Past the inline buffer: growing by realloc() can extend the block in place
+// (or mremap it, once it's large) instead of copying every element.
+struct Quote
+{
+    int64_t price;
+    int64_t qty;
+    int64_t time;
+    int32_t venue;
+    int32_t flags;
+};
+
+using StdQuotes   = std::vector<Quote>;
+using SmallQuotes = SmallVector<Quote, 4>;
+
+template <class Vec>
+static void BM_PushMany(benchmark::State& state)
+{
+    const auto n = static_cast<int64_t>(state.range(0));
+
+    for (auto _ : state) {
+        Vec v;
+        for (int64_t i = 0; i < n; ++i) {
+            v.push_back(Quote{i, i, i, 0, 0});
+        }
+        benchmark::DoNotOptimize(v.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK_TEMPLATE(BM_PushMany, StdQuotes)->Arg(1<<10)->Arg(64<<10)->Arg(4<<20);
+BENCHMARK_TEMPLATE(BM_PushMany, SmallQuotes)->Arg(1<<10)->Arg(64<<10)->Arg(4<<20);
+
+BENCHMARK_MAIN();
@@ -1,15 +1,33 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdlib>
+#include <cstring>
 #include <cassert>
+#include <algorithm>
 #include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <malloc.h>
 
+// Types that can be moved to another address with memcpy, leaving nothing to
+// destroy at the old one. Specialize for types that are, but aren't trivially
+// copyable (e.g. ones holding a unique_ptr).
 template <class T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <class T>
+inline constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+// Vector that keeps its first N elements inline, only allocating past that.
+// Trivially relocatable elements are grown in place with realloc(), and the
+// capacity includes whatever slack malloc_usable_size() reports.
+template <class T, std::size_t N = 8>
 struct SmallVector
 {
     using value_type = T;
-    using iterator = T*; // TODO: fix me
+    using iterator = T*;
     using const_iterator = const T*;
     using pointer = T*;
     using reference = T&;
@@ -18,69 +36,117 @@ struct SmallVector
 
     static_assert(std::is_nothrow_move_constructible_v<T>,
             "SmallVector only supports nothrow move constructible types");
+    static_assert(alignof(T) <= alignof(std::max_align_t),
+            "SmallVector allocates with malloc");
+
+    static constexpr bool      relocatable     = is_trivially_relocatable_v<T>;
+    static constexpr size_type inline_capacity = N;
 
     SmallVector() noexcept = default;
 
+    SmallVector(const SmallVector& other) : SmallVector()
+    {
+        reserve(other.size());
+        m_end = std::uninitialized_copy(other.m_begin, other.m_end, m_begin);
+    }
+
+    SmallVector(SmallVector&& other) noexcept : SmallVector()
+    {
+        take(std::move(other));
+    }
+
+    SmallVector& operator=(const SmallVector& other)
+    {
+        if (this != &other) {
+            clear();
+            reserve(other.size());
+            m_end = std::uninitialized_copy(other.m_begin, other.m_end, m_begin);
+        }
+        return *this;
+    }
+
+    SmallVector& operator=(SmallVector&& other) noexcept
+    {
+        if (this != &other) {
+            clear();
+            release();
+            take(std::move(other));
+        }
+        return *this;
+    }
+
     ~SmallVector() noexcept
     {
         clear();
+        release();
     }
 
     reference       operator[](std::size_t index)       noexcept { return m_begin[index]; }
     const_reference operator[](std::size_t index) const noexcept { return m_begin[index]; }
 
+    iterator       begin()       noexcept { return m_begin; }
+    iterator       end()         noexcept { return m_end; }
+    const_iterator begin() const noexcept { return m_begin; }
+    const_iterator end()   const noexcept { return m_end; }
+    pointer        data()        noexcept { return m_begin; }
+    const T*       data()  const noexcept { return m_begin; }
+
+    // keeps the capacity
     void clear() noexcept
     {
         assert(m_begin <= m_end && m_end <= m_capacity);
         std::destroy(m_begin, m_end);
-        free(m_begin);
-        m_begin = m_end = m_capacity = nullptr;
+        m_end = m_begin;
     }
 
-    bool      empty()    const noexcept { return m_begin == m_end; }
-    bool      is_empty() const noexcept { return m_begin == m_end; }
-    size_type size()     const noexcept { return m_end      - m_begin; }
-    size_type capacity() const noexcept { return m_capacity - m_begin; }
+    bool      empty()     const noexcept { return m_begin == m_end; }
+    bool      is_empty()  const noexcept { return m_begin == m_end; }
+    bool      is_inline() const noexcept { return m_begin == inline_data(); }
+    size_type size()      const noexcept { return m_end      - m_begin; }
+    size_type capacity()  const noexcept { return m_capacity - m_begin; }
 
-    void reserve(std::size_t n_elems) noexcept
+    void reserve(std::size_t n_elems)
     {
-        grow(n_elems);
+        if (n_elems > capacity()) {
+            grow(n_elems);
+        }
     }
 
-    void resize(std::size_t n_elems, const T& value = T()) noexcept
+    void resize(std::size_t n_elems)
     {
-        if (n_elems >= size()) {
-            grow(n_elems);
-            std::uninitialized_default_construct(m_end, m_capacity);
-            assert(m_begin <= m_end && m_end == m_capacity);
-        } else {
-            auto n_end = m_begin + n_elems;
-            std::destroy(n_end, m_end);
-            m_end = n_end;
-        }
+        resize_with(n_elems, [](T* first, T* last) { std::uninitialized_value_construct(first, last); });
+    }
+
+    void resize(std::size_t n_elems, const T& value)
+    {
+        resize_with(n_elems, [&](T* first, T* last) { std::uninitialized_fill(first, last, value); });
     }
 
     template <class... Args>
-    reference emplace_back(Args&&... args) noexcept
+    reference emplace_back(Args&&... args)
     {
         assert(m_begin <= m_end && m_end <= m_capacity);
         if (m_end == m_capacity) {
-            grow();
+            return grow_and_emplace_back(std::forward<Args>(args)...);
         }
         new (m_end) T{std::forward<Args>(args)...};
         return *m_end++;
     }
 
-    reference push_back(const value_type& v) noexcept
+    reference push_back(const value_type& v)
     {
         return emplace_back(v);
     }
 
+    reference push_back(value_type&& v)
+    {
+        return emplace_back(std::move(v));
+    }
+
     void pop_back() noexcept
     {
         assert(m_end != m_begin);
-        std::destroy_at(m_end);
-        --m_end;
+        std::destroy_at(--m_end);
     }
 
     reference       front()       noexcept { return *m_begin; }
@@ -90,28 +156,97 @@ struct SmallVector
     const_reference back() const noexcept { return *(m_end - 1); }
 
 private:
-    void grow(std::size_t n_elems = 16u) noexcept
+    T* inline_data() noexcept { return reinterpret_cast<T*>(m_inline); }
+    const T* inline_data() const noexcept { return reinterpret_cast<const T*>(m_inline); }
+
+    template <class F>
+    void resize_with(std::size_t n_elems, F&& construct)
+    {
+        if (n_elems > size()) {
+            reserve(n_elems);
+            construct(m_end, m_begin + n_elems);
+        } else {
+            std::destroy(m_begin + n_elems, m_end);
+        }
+        m_end = m_begin + n_elems;
+    }
+
+    // `args` may refer to an element, so construct before moving them
+    template <class... Args>
+    reference grow_and_emplace_back(Args&&... args)
+    {
+        T value{std::forward<Args>(args)...};
+        grow(size() + 1);
+        new (m_end) T(std::move(value));
+        return *m_end++;
+    }
+
+    void grow(std::size_t n_elems)
     {
         assert(m_begin <= m_end && m_end <= m_capacity);
-        auto have  = capacity();
-        auto want  = std::max<std::size_t>(have * 1.5, n_elems);
-        auto avail = malloc_usable_size(m_begin) / sizeof(T);
-        if (avail >= want) {
-            return;
+        const auto size_ = size();
+        auto want = std::max<std::size_t>({n_elems, capacity() + capacity() / 2, 4u});
+        T* p;
+        if (relocatable && !is_inline()) {
+            p = static_cast<T*>(reallocarray(m_begin, want, sizeof(T)));
+            if (!p) {
+                throw std::bad_alloc{};
+            }
+        } else {
+            p = static_cast<T*>(reallocarray(nullptr, want, sizeof(T)));
+            if (!p) {
+                throw std::bad_alloc{};
+            }
+            if constexpr (relocatable) {
+                if (size_ != 0) {
+                    memcpy(static_cast<void*>(p), m_begin, size_ * sizeof(T));
+                }
+            } else {
+                std::uninitialized_move_n(m_begin, size_, p);
+                std::destroy(m_begin, m_end);
+            }
+            release();
         }
-        auto size_ = size();
-        auto* p = static_cast<T*>(calloc(want, sizeof(T)));
-        std::uninitialized_move_n(m_begin, size_, p);
+        want = std::max(want, malloc_usable_size(p) / sizeof(T));
+        m_begin    = p;
         m_end      = p + size_;
         m_capacity = p + want;
-        m_begin    = p;
         assert(size()     == size_);
-        assert(capacity() == want);
-        assert(m_begin <= m_end && m_end < m_capacity);
+        assert(capacity() >= n_elems);
+    }
+
+    // frees the heap block, if any; the elements must be gone already
+    void release() noexcept
+    {
+        if (!is_inline()) {
+            free(m_begin);
+        }
+        m_begin = m_end = inline_data();
+        m_capacity = inline_data() + N;
+    }
+
+    // with this empty and inline
+    void take(SmallVector&& other) noexcept
+    {
+        if (other.is_inline()) {
+            if constexpr (relocatable) {
+                memcpy(static_cast<void*>(m_begin), other.m_begin, other.size() * sizeof(T));
+                m_end = m_begin + other.size();
+            } else {
+                m_end = std::uninitialized_move(other.m_begin, other.m_end, m_begin);
+                std::destroy(other.m_begin, other.m_end);
+            }
+            other.m_end = other.m_begin;
+        } else {
+            m_begin    = std::exchange(other.m_begin,    other.inline_data());
+            m_end      = std::exchange(other.m_end,      other.inline_data());
+            m_capacity = std::exchange(other.m_capacity, other.inline_data() + N);
+        }
     }
 
 private:
-    T* m_begin    = nullptr;
-    T* m_end      = nullptr;
-    T* m_capacity = nullptr;
+    T* m_begin    = inline_data();
+    T* m_end      = inline_data();
+    T* m_capacity = inline_data() + N;
+    alignas(T) unsigned char m_inline[N == 0 ? 1 : N * sizeof(T)];
 };
@@ -1,4 +1,5 @@
 #include <benchmark/benchmark.h>
+#include <array>
 #include <string>
 #include <vector>
 #include <iostream>
@@ -10,6 +11,7 @@
 #include "tarraydelta.h"
 #include "mafsa.h"
 #include "mafsa2.h"
+#include "fuzzy.h"
 
 
 static const std::array<std::string, 3> DictionaryFilenames = {
@@ -67,4 +69,48 @@ BENCHMARK_TEMPLATE(BM_IsWord_AllWords, Mafsa    ,  MafsaDictionary);
 BENCHMARK_TEMPLATE(BM_IsWord_AllWords, Mafsa2   ,  MafsaDictionary);
 
 
+// Every 64th word with one letter substituted (rotated to the next letter), so
+// each query has at least one match at k=1.
+static std::vector<std::string> make_misspellings()
+{
+    std::vector<std::string> result;
+    for (std::size_t i = 0; i < words.size(); i += 64) {
+        std::string word = words[i];
+        char& ch = word[i % word.size()];
+        ch = static_cast<char>('A' + (ch - 'A' + 1) % 26);
+        result.push_back(std::move(word));
+    }
+    return result;
+}
+
+static const std::vector<std::string> misspellings = make_misspellings();
+
+template <class T, std::size_t DictFile, int MaxEdits>
+static void BM_FuzzySearch(benchmark::State& state)
+{
+    auto maybe_dict = T::deserialize(DictionaryFilenames[DictFile]);
+    if (!maybe_dict) {
+        throw std::runtime_error("failed to deserialize dictionary!");
+    }
+    const auto& dict = *maybe_dict;
+    std::size_t matches = 0;
+    for (auto _ : state) {
+        for (const auto& word : misspellings) {
+            fuzzy_search(dict, word, MaxEdits, [&matches](std::string_view) { ++matches; });
+        }
+    }
+    benchmark::DoNotOptimize(matches);
+    const auto queries = static_cast<double>(state.iterations() * misspellings.size());
+    state.counters["latency"] = benchmark::Counter(queries, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+    state.counters["matches"] = static_cast<double>(matches) / queries;
+    if (matches < misspellings.size()) {
+        throw std::runtime_error("test failed");
+    }
+}
+BENCHMARK_TEMPLATE(BM_FuzzySearch, Mafsa2   ,  MafsaDictionary, 1);
+BENCHMARK_TEMPLATE(BM_FuzzySearch, Tarraysep, TarrayDictionary, 1);
+BENCHMARK_TEMPLATE(BM_FuzzySearch, Mafsa2   ,  MafsaDictionary, 2);
+BENCHMARK_TEMPLATE(BM_FuzzySearch, Tarraysep, TarrayDictionary, 2);
+
+
 BENCHMARK_MAIN();
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <iterator>
+#include "iconv.h"
+#include "tarraysep.h"
+#include "mafsa2.h"
+
+// Read-only views over dictionaries compiled into the binary by
+// `mkarrays ... HEADER`. The generated header holds the arrays as `inline
+// constexpr` data, so lookups run straight out of .rodata: nothing to load at
+// startup and the pages are shared between every process using the binary.
+//
+// Both views also provide `transition`/`terminal` for `fuzzy_search`.
+
+// Same layout and lookup as `Tarraysep`.
+struct TarraysepView
+{
+    using u32 = uint32_t;
+
+    const u32*  bases;
+    std::size_t n_bases;
+    const int*  checks;
+    const int*  nexts;
+    std::size_t n_checks;
+
+    constexpr bool isword(const char* word) const noexcept
+    {
+        int s = 0;
+        for (const char* p = word; *p != '\0'; ++p) {
+            const int t = base(s) + sconv(*p);
+            if (check(t) != s) {
+                return false;
+            }
+            s = nexts[static_cast<std::size_t>(t)];
+        }
+        return terminal(s);
+    }
+    bool isword(const std::string& word) const noexcept { return isword(word.c_str()); }
+
+    constexpr int transition(int s, int c) const noexcept
+    {
+        const int t = base(s) + c + Tarraysep::MIN_CHILD_OFFSET;
+        return check(t) == s ? nexts[static_cast<std::size_t>(t)] : 0;
+    }
+
+    constexpr bool terminal(int s) const noexcept
+    {
+        const auto i = static_cast<std::size_t>(s);
+        return i < n_bases && (bases[i] & Tarraysep::TERM_MASK) != 0;
+    }
+
+private:
+    constexpr int base(int s) const noexcept
+    {
+        const auto i = static_cast<std::size_t>(s);
+        return i < n_bases ? static_cast<int>(bases[i]) >> 1 : Tarraysep::NO_BASE;
+    }
+
+    constexpr int check(int t) const noexcept
+    {
+        const auto i = static_cast<std::size_t>(t);
+        return i < n_checks ? checks[i] : Tarraysep::UNSET_CHECK;
+    }
+};
+
+// Same layout and lookup as `Mafsa2`, with the terminal flags packed 64 per word.
+struct Mafsa2View
+{
+    const Mafsa2::Node* nodes;
+    std::size_t         n_nodes;
+    const uint64_t*     terms;
+
+    constexpr bool isword(const char* word) const noexcept
+    {
+        int s = 0;
+        for (const char* p = word; *p != '\0'; ++p) {
+            s = transition(s, iconv(*p));
+            if (s == 0) {
+                return false;
+            }
+        }
+        return terminal(s);
+    }
+    bool isword(const std::string& word) const noexcept { return isword(word.c_str()); }
+
+    constexpr int transition(int s, int c) const noexcept
+    {
+        return nodes[static_cast<std::size_t>(s)].children[c];
+    }
+
+    constexpr bool terminal(int s) const noexcept
+    {
+        const auto i = static_cast<std::size_t>(s);
+        return ((terms[i / 64] >> (i % 64)) & 0x1u) != 0;
+    }
+};
@@ -6,45 +6,20 @@
 #include <random>
 #include "darray.h"
 #include "darray2.h"
+#include "wordlist.h"
 
 
 template <class T>
 std::optional<T> load_dictionary(std::string path, int max_words)
 {
     T dict;
-    std::string word;
-    std::ifstream ifs{path};
-    int n_words = 0;
-    if (!ifs) {
-        std::cerr << "error: unable to open input file\n";
-        return std::nullopt;
-    }
-    while (ifs >> word) {
-        if (word.empty()) {
-            continue;
-        }
-        if (word.size() < 2 || word.size() > 15) {
-            std::cerr << "warning: skipping invalid word: \"" << word << "\"\n";
-        }
-        bool valid_word = true;
-        for (std::size_t i = 0; i < word.size(); ++i) {
-            char c = word[i];
-            if ('a' <= c && c <= 'z') {
-                word[i] = (c - 'a') + 'A';
-            } else if ('A' <= c && c <= 'Z') {
-                word[i] = c;
-            } else {
-                std::cerr << "warning: invalid character '" << c << "' in word \"" << word << "\"\n";
-                valid_word = false;
-                break;
-            }
-        }
-        if (valid_word) {
+    const bool ok = foreach_in_dictionary(path, max_words, [&dict](const char* word)
+        {
             dict.insert(word);
-            if (++n_words >= max_words) {
-                break;
-            }
-        }
+            return true;
+        });
+    if (!ok) {
+        return std::nullopt;
     }
     return dict;
 }
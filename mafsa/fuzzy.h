@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include "iconv.h"
+
+// Levenshtein automaton for a fixed query word, simulated one DP row at a time
+// (Schulz & Mihov). A state is the row of edit distances between the query and
+// the input consumed so far, clipped at `max_edits + 1`; the state is dead once
+// every entry is past `max_edits`.
+class LevenshteinAutomaton
+{
+public:
+    using u8 = uint8_t;
+
+    LevenshteinAutomaton(std::string_view word, int max_edits)
+        : m_max(static_cast<u8>(max_edits))
+    {
+        assert(0 <= max_edits && max_edits < 255);
+        m_word.reserve(word.size());
+        for (char c : word) {
+            m_word.push_back(static_cast<u8>(iconv(c)));
+        }
+    }
+
+    std::size_t row_size()  const noexcept { return m_word.size() + 1; }
+    std::size_t max_depth() const noexcept { return m_word.size() + m_max; }
+
+    void start(u8* row) const noexcept
+    {
+        for (std::size_t i = 0; i < row_size(); ++i) {
+            row[i] = clip(i);
+        }
+    }
+
+    // Writes the state reached from `row` on letter `c` (0-25) into `out` and
+    // returns its smallest entry, i.e. `out` is dead iff the result > max_edits.
+    u8 step(const u8* row, int c, u8* out) const noexcept
+    {
+        u8 lo = out[0] = clip(row[0] + 1u);
+        for (std::size_t i = 1; i < row_size(); ++i) {
+            const unsigned subst = row[i - 1] + (m_word[i - 1] != c ? 1u : 0u);
+            const unsigned indel = std::min(out[i - 1], row[i]) + 1u;
+            out[i] = clip(std::min(subst, indel));
+            lo = std::min(lo, out[i]);
+        }
+        return lo;
+    }
+
+    bool is_match(const u8* row) const noexcept { return row[m_word.size()] <= m_max; }
+    int  max_edits() const noexcept { return m_max; }
+
+private:
+    u8 clip(std::size_t v) const noexcept
+    {
+        return static_cast<u8>(std::min<std::size_t>(v, m_max + 1u));
+    }
+
+    std::vector<u8> m_word;
+    u8              m_max;
+};
+
+// Calls `on_match(std::string_view word)` for every word in `dict` within
+// `max_edits` insertions, deletions or substitutions of `word`.
+//
+// `Dict` must provide `int transition(int s, int c) const` (0 = no edge, the
+// root is never a target) and `bool terminal(int s) const`; `Mafsa2` and
+// `Tarraysep` both do. Walks the dictionary automaton depth first, pruning
+// every branch where the Levenshtein automaton is dead.
+template <class Dict, class F>
+void fuzzy_search(const Dict& dict, std::string_view word, int max_edits, F&& on_match)
+{
+    using u8 = LevenshteinAutomaton::u8;
+    const LevenshteinAutomaton lev(word, max_edits);
+    const std::size_t width = lev.row_size();
+    const std::size_t depth = lev.max_depth();
+    std::vector<u8>   rows((depth + 1) * width);
+    std::vector<char> prefix(depth);
+    lev.start(&rows[0]);
+
+    // explicit stack of (state, depth, next letter) so there is no recursion
+    struct Frame { int s; std::size_t d; int c; };
+    std::vector<Frame> stack;
+    stack.reserve(depth + 1);
+    if (lev.is_match(&rows[0]) && dict.terminal(0)) {
+        on_match(std::string_view{});
+    }
+    stack.push_back(Frame{0, 0, 0});
+    while (!stack.empty()) {
+        Frame& f = stack.back();
+        if (f.d == depth || f.c == 26) {
+            stack.pop_back();
+            continue;
+        }
+        const int c = f.c++;
+        const int t = dict.transition(f.s, c);
+        if (t == 0) {
+            continue;
+        }
+        const u8* row  = &rows[f.d * width];
+        u8*       next = &rows[(f.d + 1) * width];
+        if (lev.step(row, c, next) > max_edits) {
+            continue;
+        }
+        const std::size_t d = f.d + 1;
+        prefix[d - 1] = static_cast<char>('A' + c);
+        if (lev.is_match(next) && dict.terminal(t)) {
+            on_match(std::string_view{prefix.data(), d});
+        }
+        stack.push_back(Frame{t, d, 0});
+    }
+}
+
+template <class Dict>
+std::vector<std::string> fuzzy_search(const Dict& dict, std::string_view word, int max_edits)
+{
+    std::vector<std::string> result;
+    fuzzy_search(dict, word, max_edits,
+            [&result](std::string_view match) { result.emplace_back(match); });
+    return result;
+}
@@ -339,3 +339,19 @@ Tarraysep Mafsa::make_tarray() const
 
     return result;
 }
+
+Mafsa2 Mafsa::make_mafsa2() const
+{
+    // same node numbering as the serialized MA-FSA, so state ids line up
+    Mafsa2 result;
+    result.nodes.resize(ns.size(), Mafsa2::Node{});
+    result.terms.resize(ns.size(), false);
+    for (std::size_t i = 0; i < ns.size(); ++i) {
+        result.terms[i] = ns[i].term;
+        for (auto [val, next] : ns[i].kids) {
+            assert(0 <= val && val < 26);
+            result.nodes[i].children[val] = next;
+        }
+    }
+    return result;
+}
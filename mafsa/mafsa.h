@@ -8,6 +8,7 @@
 #include <cstdint>
 #include <optional>
 #include "tarraysep.h"
+#include "mafsa2.h"
 
 
 struct Mafsa
@@ -61,6 +62,7 @@ struct Mafsa
     static bool nodecmp(const Node& a, const Node& b);
 
     Tarraysep make_tarray() const;
+    Mafsa2    make_mafsa2() const;
 
     std::vector<Node> ns;
 };
@@ -18,6 +18,11 @@ struct Mafsa2
 
     bool isword(const char* const word) const noexcept;
     bool isword(const std::string& word) const noexcept { return isword(word.c_str()); }
+
+    // state reached from `s` on letter `c` (0-25), 0 if there is no edge
+    int  transition(int s, int c) const noexcept { return nodes[static_cast<std::size_t>(s)].children[c]; }
+    bool terminal(int s) const noexcept { return terms[static_cast<std::size_t>(s)]; }
+
     void dump_stats(std::ostream& os) const;
     static std::optional<Mafsa2> deserialize(const std::string& filename);
 };
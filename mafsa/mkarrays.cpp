@@ -3,51 +3,28 @@
 #include <optional>
 #include <string>
 #include <climits>
+#include <cctype>
 #include "mafsa.h"
 #include "mafsa_generated.h"
 #include "darray.h"
 #include "darray_generated.h"
 #include "tarraysep.h"
 #include "tarray_generated.h"
+#include "mafsa2.h"
+#include "wordlist.h"
 
 
 template <class T>
 std::optional<T> load_dictionary(std::string path, int max_words)
 {
     T dict;
-    std::string word;
-    std::ifstream ifs{path};
-    int n_words = 0;
-    if (!ifs) {
-        std::cerr << "error: unable to open input file\n";
-        return std::nullopt;
-    }
-    while (ifs >> word) {
-        if (word.empty()) {
-            continue;
-        }
-        if (word.size() < 2 || word.size() > 15) {
-            std::cerr << "warning: skipping invalid word: \"" << word << "\"\n";
-        }
-        bool valid_word = true;
-        for (std::size_t i = 0; i < word.size(); ++i) {
-            char c = word[i];
-            if ('a' <= c && c <= 'z') {
-                word[i] = (c - 'a') + 'A';
-            } else if ('A' <= c && c <= 'Z') {
-                word[i] = c;
-            } else {
-                std::cerr << "warning: invalid character '" << c << "' in word \"" << word << "\"\n";
-                valid_word = false;
-                break;
-            }
-        }
-        if (valid_word) {
+    const bool ok = foreach_in_dictionary(path, max_words, [&dict](const char* word)
+        {
             dict.insert(word);
-            if (++n_words >= max_words) {
-                break;
-            }
-        }
+            return true;
+        });
+    if (!ok) {
+        return std::nullopt;
     }
     return dict;
 }
@@ -55,44 +32,14 @@ std::optional<T> load_dictionary(std::string path, int max_words)
 template <class T>
 bool test_dictionary(const T& dict, std::string path, int max_words)
 {
-    std::string word;
-    std::ifstream ifs{path};
-    int n_words = 0;
-    if (!ifs) {
-        std::cerr << "error: unable to open input file\n";
-        return false;
-    }
-    while (ifs >> word) {
-        if (word.empty()) {
-            continue;
-        }
-        if (word.size() < 2 || word.size() > 15) {
-            std::cerr << "warning: skipping invalid word: \"" << word << "\"\n";
-        }
-        bool valid_word = true;
-        for (std::size_t i = 0; i < word.size(); ++i) {
-            char c = word[i];
-            if ('a' <= c && c <= 'z') {
-                word[i] = (c - 'a') + 'A';
-            } else if ('A' <= c && c <= 'Z') {
-                word[i] = c;
-            } else {
-                std::cerr << "warning: invalid character '" << c << "' in word \"" << word << "\"\n";
-                valid_word = false;
-                break;
-            }
-        }
-        if (valid_word) {
+    return foreach_in_dictionary(path, max_words, [&dict](const char* word)
+        {
             if (!dict.isword(word)) {
                 std::cerr << "Failed on word: " << word << "\n";
                 return false;
             }
-            if (++n_words >= max_words) {
-                break;
-            }
-        }
-    }
-    return true;
+            return true;
+        });
 }
 
 std::string make_out_filename(std::string inname, std::string newext)
@@ -161,6 +108,79 @@ bool write_mafsa(const Mafsa& mafsa, const std::string& filename)
     return write_data(filename, buf, len);
 }
 
+template <class It, class F>
+void write_values(std::ostream& os, It first, It last, F&& fmt)
+{
+    std::size_t i = 0;
+    for (; first != last; ++first, ++i) {
+        os << (i % 16 == 0 ? "\n    " : " ") << fmt(*first) << ",";
+    }
+    os << "\n";
+}
+
+// Namespace for the generated header: the file's stem, e.g. "csw19.h" -> csw19
+std::string make_namespace(const std::string& filename)
+{
+    auto begin = filename.rfind('/');
+    begin = begin == std::string::npos ? 0 : begin + 1;
+    std::string result = filename.substr(begin, filename.find('.', begin) - begin);
+    for (auto& ch : result) {
+        if (!std::isalnum(static_cast<unsigned char>(ch))) {
+            ch = '_';
+        }
+    }
+    if (result.empty() || std::isdigit(static_cast<unsigned char>(result[0]))) {
+        result.insert(0, "dict_");
+    }
+    return result;
+}
+
+// Emits `tarray` and `mafsa2` as a C++ header of inline constexpr arrays with
+// a `TarraysepView tarray` and `Mafsa2View mafsa` over them (see embedded.h).
+bool write_embedded(const Tarraysep& tarray, const Mafsa2& mafsa2, const std::string& filename)
+{
+    std::ofstream ofs{filename};
+    if (!ofs) {
+        return false;
+    }
+    auto ident = [](auto x) { return x; };
+    ofs << "#pragma once\n\n"
+        << "// Generated by mkarrays. Do not edit by hand.\n\n"
+        << "#include \"embedded.h\"\n\n"
+        << "namespace " << make_namespace(filename) << " {\n\n";
+
+    ofs << "inline constexpr TarraysepView::u32 tarray_bases[] = {";
+    write_values(ofs, tarray.bases.begin(), tarray.bases.end(), ident);
+    ofs << "};\n\ninline constexpr int tarray_checks[] = {";
+    write_values(ofs, tarray.checks.begin(), tarray.checks.end(), ident);
+    ofs << "};\n\ninline constexpr int tarray_nexts[] = {";
+    write_values(ofs, tarray.nexts.begin(), tarray.nexts.end(), ident);
+    ofs << "};\n\ninline constexpr TarraysepView tarray{\n"
+        << "    tarray_bases, std::size(tarray_bases),\n"
+        << "    tarray_checks, tarray_nexts, std::size(tarray_checks),\n"
+        << "};\n\n";
+
+    ofs << "inline constexpr Mafsa2::Node mafsa_nodes[] = {\n";
+    for (const auto& node : mafsa2.nodes) {
+        ofs << "    {{";
+        for (int c = 0; c < 26; ++c) {
+            ofs << (c == 0 ? "" : ",") << node.children[c];
+        }
+        ofs << "}},\n";
+    }
+    std::vector<uint64_t> terms((mafsa2.terms.size() + 63) / 64, 0);
+    for (std::size_t i = 0; i < mafsa2.terms.size(); ++i) {
+        if (mafsa2.terms[i]) {
+            terms[i / 64] |= uint64_t{1} << (i % 64);
+        }
+    }
+    ofs << "};\n\ninline constexpr uint64_t mafsa_terms[] = {";
+    write_values(ofs, terms.begin(), terms.end(), [](uint64_t x) { return std::to_string(x) + "u"; });
+    ofs << "};\n\ninline constexpr Mafsa2View mafsa{ mafsa_nodes, std::size(mafsa_nodes), mafsa_terms };\n\n"
+        << "} // namespace " << make_namespace(filename) << "\n";
+    return static_cast<bool>(ofs);
+}
+
 std::ostream& operator<<(std::ostream& os, const Mafsa::Node& n)
 {
     os << "value=" << n.val << ", term=" << (n.term ? "TRUE":"FALSE") << ", kids=[ ";
@@ -184,11 +204,13 @@ int main(int argc, char** argv)
     const std::string doutname  = argc >= 4 ? argv[3]       : make_out_filename(inname, ".ddic");
     const std::string toutname  = argc >= 5 ? argv[4]       : make_out_filename(inname, ".tdic");
     const std::string moutname  = argc >= 6 ? argv[5]       : make_out_filename(inname, ".mfsa");
+    const std::string houtname  = argc >= 7 ? argv[6]       : ""; // optional embedded header
 
     std::cout << "INPUT:     " << inname    << "\n"
               << "OUTPUT   : " << doutname  << "\n"
               << "OUTPUT   : " << toutname  << "\n"
               << "OUTPUT   : " << moutname  << "\n"
+              << "OUTPUT   : " << (houtname.empty() ? "(no header)" : houtname) << "\n"
               << "MAX WORDS: " << max_words << "\n"
               ;
 
@@ -252,6 +274,18 @@ int main(int argc, char** argv)
             }
         }
 
+        if (!houtname.empty()) {
+            const auto tarray = mafsa.make_tarray();
+            if (!test_dictionary<Tarraysep>(tarray, inname, max_words)) {
+                std::cerr << "dictionary test failed!" << std::endl;
+                return 1;
+            }
+            if (!write_embedded(tarray, mafsa.make_mafsa2(), houtname)) {
+                std::cerr << "error: unable to write " << houtname << std::endl;
+                return 1;
+            }
+        }
+
         if (0) {
             const auto& tarray = mafsa.make_tarray();
             if (!test_dictionary<Tarraysep>(tarray, inname, max_words)) {
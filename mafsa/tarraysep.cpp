@@ -29,6 +29,12 @@ bool Tarraysep::isword(const char* const word) const noexcept
     return term(s);
 }
 
+int Tarraysep::transition(int s, int c) const noexcept
+{
+    const int t = base(s) + c + MIN_CHILD_OFFSET;
+    return check(t) == s ? nexts[static_cast<std::size_t>(t)] : 0;
+}
+
 int Tarraysep::base(int index) const noexcept
 {
     auto s = static_cast<std::size_t>(index);
@@ -27,6 +27,10 @@ struct Tarraysep
     bool isword(const char* const word)  const noexcept;
     bool isword(const std::string& word) const noexcept { return isword(word.c_str()); }
 
+    // state reached from `s` on letter `c` (0-25), 0 if there is no edge
+    int  transition(int s, int c) const noexcept;
+    bool terminal(int s) const noexcept { return term(s) != 0; }
+
     // TODO(peter): maybe move this to a "serializers.h"?
     static std::optional<Tarraysep> deserialize(const std::string& filename);
 
@@ -1,13 +1,20 @@
 #include <catch2/catch.hpp>
 #include <iostream>
+#include <fstream>
+#include <cstdio>
 #include <vector>
 #include <unordered_set>
+#include <algorithm>
 #include "darray.h"
 #include "darray2.h"
 #include "darray3.h"
 #include "tarray.h"
 #include "tarraysep.h"
 #include "mafsa.h"
+#include "mafsa2.h"
+#include "fuzzy.h"
+#include "test_dict.h" // generated by `mkarrays` from DICT
+#include "wordlist.h"
 
 // clang-format off
 const std::vector<std::string> DICT = {
@@ -420,3 +427,133 @@ TEST_CASE("Tarray")
         CHECK(tarray.isword(word) == false);
     }
 }
+
+static int levenshtein(const std::string& a, const std::string& b)
+{
+    std::vector<int> row(b.size() + 1);
+    for (std::size_t j = 0; j <= b.size(); ++j) {
+        row[j] = static_cast<int>(j);
+    }
+    for (std::size_t i = 1; i <= a.size(); ++i) {
+        int diag = row[0];
+        row[0] = static_cast<int>(i);
+        for (std::size_t j = 1; j <= b.size(); ++j) {
+            const int up = row[j];
+            row[j] = std::min({ row[j] + 1, row[j - 1] + 1, diag + (a[i - 1] != b[j - 1] ? 1 : 0) });
+            diag = up;
+        }
+    }
+    return row[b.size()];
+}
+
+TEST_CASE("Fuzzy search")
+{
+    Mafsa m;
+    for (const auto& word : DICT) {
+        m.insert(word);
+    }
+    m.reduce();
+    const auto tarray = m.make_tarray();
+    const auto mafsa2 = m.make_mafsa2();
+
+    std::vector<std::string> queries = { "A", "AAH", "AB", "ZZZ", "ACCOUNTS", "ACCOUTREMENT" };
+    queries.insert(queries.end(), MISSING.begin(), MISSING.end());
+    for (const auto& word : DICT) {
+        queries.push_back(word);
+        queries.push_back(word.substr(1));
+        queries.push_back(word + "S");
+        std::string swapped = word;
+        std::swap(swapped[0], swapped[1]);
+        queries.push_back(swapped);
+    }
+
+    for (int k : { 0, 1, 2 }) {
+        for (const auto& query : queries) {
+            std::vector<std::string> expect;
+            for (const auto& word : DICT) {
+                if (levenshtein(query, word) <= k) {
+                    expect.push_back(word);
+                }
+            }
+            std::sort(expect.begin(), expect.end());
+
+            auto from_mafsa2 = fuzzy_search(mafsa2, query, k);
+            std::sort(from_mafsa2.begin(), from_mafsa2.end());
+            CHECK(from_mafsa2 == expect);
+
+            auto from_tarray = fuzzy_search(tarray, query, k);
+            std::sort(from_tarray.begin(), from_tarray.end());
+            CHECK(from_tarray == expect);
+        }
+    }
+}
+
+// lookups on the embedded arrays are usable at compile time too
+static_assert( test_dict::tarray.isword("AARDWOLVES"));
+static_assert(!test_dict::tarray.isword("AARDWOLFS"));
+static_assert( test_dict::mafsa.isword("AARDWOLVES"));
+static_assert(!test_dict::mafsa.isword("AARDWOLFS"));
+
+TEST_CASE("Embedded")
+{
+    for (const auto& word : DICT) {
+        CHECK(test_dict::tarray.isword(word) == true);
+        CHECK(test_dict::mafsa .isword(word) == true);
+    }
+
+    for (const auto& word : MISSING) {
+        CHECK(test_dict::tarray.isword(word) == false);
+        CHECK(test_dict::mafsa .isword(word) == false);
+    }
+
+    Mafsa m;
+    for (const auto& word : DICT) {
+        m.insert(word);
+    }
+    m.reduce();
+    const auto tarray = m.make_tarray();
+    for (const auto& word : DICT) {
+        const auto query = word.substr(1);
+        CHECK(fuzzy_search(test_dict::tarray, query, 1) == fuzzy_search(tarray, query, 1));
+        CHECK(fuzzy_search(test_dict::mafsa , query, 1) == fuzzy_search(tarray, query, 1));
+    }
+}
+
+TEST_CASE("WordList")
+{
+    const std::string filename = "test_arrays_wordlist.txt";
+    {
+        // long enough that words straddle the 32 byte blocks
+        std::ofstream ofs{filename, std::ios::binary};
+        ofs << "aa  AAH\taahed\r\nAAHING\n\n  aahs x1y aardvarks\v\fAARDWOLVES ceanothuses lastword";
+    }
+    const std::vector<std::pair<std::string, bool>> expect = {
+        { "AA"         , true  },
+        { "AAH"        , true  },
+        { "AAHED"      , true  },
+        { "AAHING"     , true  },
+        { "AAHS"       , true  },
+        { "X1Y"        , false },
+        { "AARDVARKS"  , true  },
+        { "AARDWOLVES" , true  },
+        { "CEANOTHUSES", true  },
+        { "LASTWORD"   , true  },
+    };
+
+    auto words = WordList::open(filename);
+    REQUIRE(words);
+    std::size_t i = 0;
+    WordList::Word word;
+    while (words->next(word)) {
+        REQUIRE(i < expect.size());
+        CHECK(std::string{word.c_str()} == expect[i].first);
+        CHECK(word.size() == expect[i].first.size());
+        CHECK(word.valid == expect[i].second);
+        ++i;
+    }
+    CHECK(i == expect.size());
+    CHECK(!words->next(word));
+    std::remove(filename.c_str());
+
+    CHECK(!WordList::open("does/not/exist.txt"));
+}
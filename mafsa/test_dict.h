@@ -0,0 +1,230 @@
+#pragma once
+
+// Generated by mkarrays. Do not edit by hand.
+
+#include "embedded.h"
+
+namespace test_dict {
+
+inline constexpr TarraysepView::u32 tarray_bases[] = {
+    0, 2, 4294967289, 1, 4, 1, 270, 286, 1, 1, 17, 6, 4294967289, 24, 12, 34,
+    12, 38, 25, 34, 42, 56, 1, 60, 352, 64, 74, 50, 50, 42, 68, 44,
+    52, 83, 87, 91, 86, 70, 98, 141, 102, 78, 80, 126, 138, 104, 134, 112,
+    140, 154, 164, 132, 148, 156, 166, 118, 80, 104, 116, 122, 116, 96, 392, 368,
+    371, 164, 172, 182, 146, 180, 152, 168, 192, 168, 190, 162, 200, 180, 1, 176,
+    202, 160, 1, 218, 216, 214, 196, 186, 192, 214, 194, 218, 232, 1, 208, 236,
+    244, 208, 232, 212, 248, 253, 246, 260, 228, 254, 248, 260, 228, 272, 1, 266,
+    280, 278, 254, 284, 280, 298, 302, 308, 276, 278, 302, 294, 310, 288, 324, 320,
+    324, 298, 298, 303, 312, 332, 306, 346, 334, 315, 318, 1, 356, 334, 330, 314,
+    342, 348, 372, 1, 326, 352, 350, 344, 382, 358, 350, 368, 386, 358,
+};
+
+inline constexpr int tarray_checks[] = {
+    0, 0, 1, 0, 2, 3, 4, 0, 2, 3, 6, 7, 11, 0, 2, 12,
+    13, 10, 15, 3, 0, 0, 0, 0, 16, 0, 0, 10, 14, 14, 17, 18,
+    19, 20, 21, 23, 24, 25, 26, 27, 28, 29, 30, 31, 27, 32, 33, 24,
+    34, 35, 21, 35, 36, 37, 38, 39, 40, 35, 41, 42, 55, 56, 57, 58,
+    57, 24, 59, 60, 61, 62, 63, 64, 43, 44, 44, 45, 46, 45, 47, 48,
+    6, 7, 49, 50, 51, 64, 52, 53, 54, 39, 65, 66, 67, 68, 70, 69,
+    71, 72, 73, 74, 75, 76, 77, 71, 79, 81, 80, 65, 69, 80, 83, 84,
+    85, 86, 87, 88, 89, 90, 91, 92, 94, 83, 95, 96, 97, 98, 6, 7,
+    99, 100, 101, 96, 102, 103, 104, 92, 105, 106, 102, 107, 108, 109, 111, 112,
+    113, 114, 114, 64, 113, 6, 7, 115, 116, 117, 118, 119, 118, 115, 120, 121,
+    122, 123, 124, 125, 126, 127, 126, 128, 129, 130, 131, 132, 133, 134, 135, 136,
+    137, 138, 135, 140, 141, 142, 143, 144, 142, 145, 142, 146, 148, 149, 150, 151,
+    152, 153, 154, 24, 152, 155, 156, 157, 152, 62, 63, 155, 64, 1073741797, 1073741797, 1073741797,
+    1073741797, 1073741797, 1073741797, 1073741797, 1073741797, 1073741797, 1073741797, 1073741797, 1073741797, 1073741797, 1073741797, 1073741797, 1073741797, 1073741797, 1073741797, 1073741797,
+    1073741797, 1073741797, 1073741797, 1073741797,
+};
+
+inline constexpr int tarray_nexts[] = {
+    0, 1, 2, 25, 3, 4, 5, 55, 10, 6, 7, 8, 12, 43, 13, 9,
+    14, 11, 16, 9, 65, 94, 102, 115, 17, 140, 148, 9, 15, 19, 18, 9,
+    20, 21, 22, 24, 9, 26, 27, 28, 29, 30, 31, 32, 34, 33, 24, 9,
+    35, 5, 23, 36, 37, 38, 39, 9, 41, 40, 42, 9, 56, 57, 58, 24,
+    59, 9, 60, 61, 62, 63, 64, 9, 44, 45, 52, 46, 47, 49, 48, 6,
+    7, 8, 50, 51, 64, 9, 53, 54, 39, 9, 66, 67, 68, 69, 71, 70,
+    72, 73, 74, 75, 9, 77, 78, 9, 80, 82, 81, 79, 76, 83, 84, 85,
+    86, 87, 88, 9, 90, 91, 92, 93, 95, 89, 96, 97, 98, 6, 7, 8,
+    100, 101, 5, 99, 103, 104, 105, 9, 106, 107, 111, 108, 109, 110, 112, 113,
+    114, 64, 9, 9, 6, 7, 8, 116, 117, 118, 119, 120, 126, 132, 121, 122,
+    123, 124, 125, 9, 127, 128, 5, 129, 130, 131, 9, 133, 134, 135, 136, 137,
+    9, 139, 138, 141, 142, 143, 82, 145, 9, 146, 144, 147, 149, 150, 151, 152,
+    153, 154, 9, 9, 24, 156, 157, 62, 155, 63, 64, 9, 9, 0, 0, 0,
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 0,
+};
+
+inline constexpr TarraysepView tarray{
+    tarray_bases, std::size(tarray_bases),
+    tarray_checks, tarray_nexts, std::size(tarray_checks),
+};
+
+inline constexpr Mafsa2::Node mafsa_nodes[] = {
+    {{1,0,25,0,0,0,55,0,0,0,0,0,43,0,0,0,0,0,0,65,94,102,115,0,140,148}},
+    {{2,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,3,0,0,0,10,0,0,0,0,0,13,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,4,0,0,0,6,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,5,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,7,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,8,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,11,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,12,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,14,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,15,19,0,0,0}},
+    {{16,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,17,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,18,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,20,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,21,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,22,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,23,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,24,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,26,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{27,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,28,0,0,0,0,34,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,29,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,30,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,31,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,32,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,33,0,0,0,0,0,0,0}},
+    {{0,0,0,0,24,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,35,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,5,0,36,0,0,0,0,0,40,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,37,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,38,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,39,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,41,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,42,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,44,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,45,52,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,46,0,49,0}},
+    {{0,0,0,0,0,0,0,0,47,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,48,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,6,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,50,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{51,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,64,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,53,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,54,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,39,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{56,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,57,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,58,0,59,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,24,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,60,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,61,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,62,0,0,0,0,0,0}},
+    {{0,0,0,0,63,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,64,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,66,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,79,0}},
+    {{0,0,0,0,67,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{68,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,69,0,0,0,0,0,0}},
+    {{0,0,0,0,70,0,0,0,0,0,0,0,0,0,0,0,0,76,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,71,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,72,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{73,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,74,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,75,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{77,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,78,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,80,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,81,0,0,83,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,82,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{84,0,0,0,0,0,0,0,0,0,0,89,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,85,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,86,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,87,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,88,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,90,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,91,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,92,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,93,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,95,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,96,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{97,0,0,0,0,0,0,0,99,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,98,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,6,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,100,0,0,0,0}},
+    {{0,0,0,0,101,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,5,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,103,0,0,0,0,0,111,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,104,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,105,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,106,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,107,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,108,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,109}},
+    {{0,0,0,0,110,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,112,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,113,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,114,0,0,0,6,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,64,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,116,0,0,0,0,0,132,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,117,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,118,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,119,0,126,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{120,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,121,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,122,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,123,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,124,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,125,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,127,0,5,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,128,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,129,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,130,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,131,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,133,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,134,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,135,0,0,0,0,0,0}},
+    {{136,0,0,0,138,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,137,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,139,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{141,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,142,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,143,0,0,9,0,144,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,82,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,145,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,146,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{147,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,149,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,150,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,151,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,152,0,0,0,0,0,0,0}},
+    {{153,0,0,0,24,0,0,0,155,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,154,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,156,0,0,0,0,0,9,0,0,0,0,0,0,0}},
+    {{0,0,0,0,157,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0}},
+    {{0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,0,62,0,0,0,0,0,0}},
+};
+
+inline constexpr uint64_t mafsa_terms[] = {
+    609889818412u, 70506720280577u, 526856u,
+};
+
+inline constexpr Mafsa2View mafsa{ mafsa_nodes, std::size(mafsa_nodes), mafsa_terms };
+
+} // namespace test_dict
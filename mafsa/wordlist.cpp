@@ -0,0 +1,210 @@
+#include "wordlist.h"
+#include <cassert>
+#include <cstring>
+#include <utility>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+
+// Classifies and rewrites `p[0..32)` in place: upcases letters and turns
+// whitespace into '\0'. Sets bit i of `ws` if p[i] was whitespace and bit i of
+// `bad` if p[i] was neither whitespace nor a letter.
+#ifdef __AVX2__
+static void classify_block(char* p, uint32_t& ws, uint32_t& bad) noexcept
+{
+    // same pshufb lookup as `simd_cmpws_i8` in wc/my_simd.h: matches
+    // ' ', '\t', '\n', '\v', '\f', '\r'
+    const __m256i shuffle_src = _mm256_set_epi64x(0x0d0c0b0a0900, 0x20,
+                                                  0x0d0c0b0a0900, 0x20);
+    const __m256i v       = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i isws    = _mm256_cmpeq_epi8(_mm256_shuffle_epi8(shuffle_src, v), v);
+    // bytes >= 0x80 are negative so fail both (signed) range checks
+    const __m256i islower = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('a' - 1)),
+                                             _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), v));
+    const __m256i isupper = _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8('A' - 1)),
+                                             _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), v));
+    const __m256i isalpha = _mm256_or_si256(islower, isupper);
+    const __m256i upcased = _mm256_sub_epi8(v, _mm256_and_si256(islower, _mm256_set1_epi8(0x20)));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), _mm256_andnot_si256(isws, upcased));
+    ws  = static_cast<uint32_t>(_mm256_movemask_epi8(isws));
+    bad = ~(ws | static_cast<uint32_t>(_mm256_movemask_epi8(isalpha)));
+}
+#else
+static void classify_block(char* p, uint32_t& ws, uint32_t& bad) noexcept
+{
+    ws  = 0;
+    bad = 0;
+    for (uint32_t i = 0; i < 32; ++i) {
+        const char c = p[i];
+        if (c == ' ' || ('\t' <= c && c <= '\r')) {
+            ws |= 1u << i;
+            p[i] = '\0';
+        } else if ('a' <= c && c <= 'z') {
+            p[i] = static_cast<char>((c - 'a') + 'A');
+        } else if (!('A' <= c && c <= 'Z')) {
+            bad |= 1u << i;
+        }
+    }
+}
+#endif
+
+static uint64_t bits_from(unsigned pos) noexcept
+{
+    return ~uint64_t{0} << pos;
+}
+
+char WordList::Word::first_invalid_char() const noexcept
+{
+    for (std::size_t i = 0; i < len; ++i) {
+        const char c = str[i];
+        if (!('A' <= c && c <= 'Z')) {
+            return c;
+        }
+    }
+    return '\0';
+}
+
+std::optional<WordList> WordList::open(const std::string& filename)
+{
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return std::nullopt;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return std::nullopt;
+    }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    if (size == 0) {
+        close(fd);
+        return WordList{nullptr, 0};
+    }
+    // private + writable: tokenizing writes into the page cache copy only
+    void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return std::nullopt;
+    }
+    madvise(p, size, MADV_SEQUENTIAL);
+    return WordList{static_cast<char*>(p), size};
+}
+
+WordList::WordList(char* data, std::size_t size) noexcept
+    : m_data(data)
+    , m_size(size)
+{
+}
+
+WordList::WordList(WordList&& other) noexcept
+{
+    *this = std::move(other);
+}
+
+WordList& WordList::operator=(WordList&& other) noexcept
+{
+    if (this != &other) {
+        if (m_data) {
+            munmap(m_data, m_size);
+        }
+        m_data    = std::exchange(other.m_data, nullptr);
+        m_size    = std::exchange(other.m_size, 0);
+        m_block   = other.m_block;
+        m_next    = other.m_next;
+        m_ws      = other.m_ws;
+        m_bad     = other.m_bad;
+        m_cursor  = other.m_cursor;
+        m_inword  = other.m_inword;
+        m_wordbad = other.m_wordbad;
+        m_start   = other.m_start;
+        m_tail    = std::move(other.m_tail);
+    }
+    return *this;
+}
+
+WordList::~WordList() noexcept
+{
+    if (m_data) {
+        munmap(m_data, m_size);
+    }
+}
+
+bool WordList::load_block() noexcept
+{
+    if (m_next >= m_size) {
+        return false;
+    }
+    uint32_t ws, bad;
+    const std::size_t avail = m_size - m_next;
+    if (avail >= BLOCK) {
+        classify_block(&m_data[m_next], ws, bad);
+    } else {
+        // pad the tail with whitespace so the padding never extends a word
+        char buf[BLOCK];
+        memset(buf, ' ', sizeof(buf));
+        memcpy(buf, &m_data[m_next], avail);
+        classify_block(buf, ws, bad);
+        memcpy(&m_data[m_next], buf, avail);
+    }
+    m_block  = m_next;
+    m_next  += BLOCK;
+    m_ws     = ws;
+    m_bad    = bad;
+    m_cursor = 0;
+    return true;
+}
+
+WordList::Word WordList::finish_word(std::size_t end) noexcept
+{
+    Word word;
+    word.len   = end - m_start;
+    word.valid = !m_wordbad;
+    if (end < m_size) {
+        word.str = &m_data[m_start]; // terminated by the rewritten whitespace
+    } else {
+        m_tail.assign(&m_data[m_start], word.len);
+        word.str = m_tail.c_str();
+    }
+    m_inword = false;
+    return word;
+}
+
+bool WordList::next(Word& word) noexcept
+{
+    for (;;) {
+        if (m_cursor < BLOCK) {
+            if (!m_inword) {
+                const uint64_t starts = ~m_ws & bits_from(m_cursor) & 0xFFFFFFFFu;
+                if (starts == 0) {
+                    m_cursor = BLOCK;
+                    continue;
+                }
+                m_cursor  = static_cast<unsigned>(__builtin_ctzll(starts));
+                m_start   = m_block + m_cursor;
+                m_inword  = true;
+                m_wordbad = false;
+            }
+            const uint64_t live = bits_from(m_cursor) & 0xFFFFFFFFu;
+            const uint64_t ends = m_ws & live;
+            const unsigned end  = ends != 0 ? static_cast<unsigned>(__builtin_ctzll(ends)) : BLOCK;
+            m_wordbad |= (m_bad & live & ~bits_from(end)) != 0;
+            m_cursor   = end;
+            if (ends != 0) {
+                word = finish_word(m_block + end);
+                return true;
+            }
+        }
+        if (!load_block()) {
+            if (m_inword) {
+                word = finish_word(m_size);
+                return true;
+            }
+            return false;
+        }
+    }
+}
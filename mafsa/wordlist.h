@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <iostream>
+#include <string_view>
+#include <optional>
+
+// Streaming reader for whitespace separated word lists (e.g. csw19.txt).
+//
+// The file is mmap'd copy-on-write and tokenized in place 32 bytes at a time:
+// letters are upcased, whitespace is overwritten with '\0' so every word is
+// already a C string, and each word is flagged if it contains anything other
+// than [A-Za-z]. No per-word allocation.
+class WordList
+{
+public:
+    struct Word
+    {
+        const char* str;   // NUL-terminated, upcased
+        std::size_t len;
+        bool        valid; // only [A-Z]
+
+        const char*      c_str() const noexcept { return str; }
+        std::size_t      size()  const noexcept { return len; }
+        std::string_view view()  const noexcept { return { str, len }; }
+        char first_invalid_char() const noexcept;
+    };
+
+    static std::optional<WordList> open(const std::string& filename);
+
+    WordList(WordList&& other) noexcept;
+    WordList& operator=(WordList&& other) noexcept;
+    WordList(const WordList&) = delete;
+    WordList& operator=(const WordList&) = delete;
+    ~WordList() noexcept;
+
+    // returns false once the input is exhausted
+    bool next(Word& word) noexcept;
+
+    std::size_t size() const noexcept { return m_size; }
+
+private:
+    WordList(char* data, std::size_t size) noexcept;
+    bool load_block() noexcept;
+    Word finish_word(std::size_t end) noexcept;
+
+    static constexpr std::size_t BLOCK = 32;
+
+    char*       m_data   = nullptr;
+    std::size_t m_size   = 0;
+    std::size_t m_block  = 0;     // offset of current block
+    std::size_t m_next   = 0;     // offset of next block to classify
+    uint64_t    m_ws     = 0;     // whitespace bits for current block
+    uint64_t    m_bad    = 0;     // invalid character bits for current block
+    unsigned    m_cursor = BLOCK; // bit position within current block
+    bool        m_inword = false;
+    bool        m_wordbad = false;
+    std::size_t m_start  = 0;     // offset of current word
+    std::string m_tail;           // last word, if it runs up to EOF
+};
+
+// Calls `f(const char* word)` for each valid word in `path`, up to `max_words`,
+// warning about malformed entries on stderr. Stops early if `f` returns false.
+template <class F>
+bool foreach_in_dictionary(const std::string& path, int max_words, F&& f)
+{
+    auto words = WordList::open(path);
+    if (!words) {
+        std::cerr << "error: unable to open input file\n";
+        return false;
+    }
+    int n_words = 0;
+    WordList::Word word;
+    while (n_words < max_words && words->next(word)) {
+        if (word.size() < 2 || word.size() > 15) {
+            std::cerr << "warning: skipping invalid word: \"" << word.view() << "\"\n";
+        }
+        if (!word.valid) {
+            std::cerr << "warning: invalid character '" << word.first_invalid_char() << "' in word \"" << word.view() << "\"\n";
+            continue;
+        }
+        if (!f(word.c_str())) {
+            return false;
+        }
+        ++n_words;
+    }
+    return true;
+}
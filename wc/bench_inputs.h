@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <string>
+
+// Inputs shared by the wc benchmarks.
+
+// `size` bytes with the same alphabet and shuffling as geninputs.py: upper
+// and lower case letters, five spaces and a line feed, reshuffled after
+// every pass
+inline std::string geninputs_text(std::size_t size)
+{
+    std::string alphabet;
+    for (char c = 'A'; c <= 'Z'; ++c) {
+        alphabet += c;
+    }
+    for (char c = 'a'; c <= 'z'; ++c) {
+        alphabet += c;
+    }
+    alphabet += std::string(5, ' ');
+    alphabet += '\n';
+
+    std::mt19937 gen(42);
+    std::string result;
+    result.reserve(size + alphabet.size());
+    while (result.size() < size) {
+        std::shuffle(alphabet.begin(), alphabet.end(), gen);
+        result += alphabet;
+    }
+    result.resize(size);
+    return result;
+}
@@ -0,0 +1,123 @@
+#include <benchmark/benchmark.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "bench_inputs.h"
+#include "wc.h"
+#include "wc_classify.h"
+
+// The byte-class scanner next to the line/word counter it generalizes, all
+// over the same 64 MiB of geninputs.py-style text, plus CSV counting on a
+// generated CSV file of the same size.
+
+static constexpr std::size_t InputSize = 64u << 20;
+
+static const std::string& text_input()
+{
+    static const std::string data = geninputs_text(InputSize);
+    return data;
+}
+
+// 8 fields per record: numbers, words, and every fourth field quoted with an
+// embedded delimiter or escaped quote
+static const std::string& csv_input()
+{
+    static const std::string data = [] {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> number(0, 1000000);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        std::uniform_int_distribution<int> length(1, 12);
+        std::string result;
+        while (result.size() < InputSize) {
+            for (int f = 0; f < 8; ++f) {
+                if (f > 0) {
+                    result += ',';
+                }
+                if (f % 4 == 3) {
+                    result += "\"a, \"\"b\"\"\"";
+                } else if (f % 2 == 0) {
+                    result += std::to_string(number(gen));
+                } else {
+                    for (int n = length(gen); n > 0; --n) {
+                        result += static_cast<char>(letter(gen));
+                    }
+                }
+            }
+            result += '\n';
+        }
+        result.resize(result.rfind('\n') + 1);
+        return result;
+    }();
+    return data;
+}
+
+static void BM_LineWord(benchmark::State& state)
+{
+    const auto& data = text_input();
+    wc_state wc;
+    for (auto _ : state) {
+        wc_state_init(&wc, nullptr, 0);
+        wc_feed(&wc, data.data(), data.size());
+        auto r = wc_finish(&wc);
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK(BM_LineWord)->Unit(benchmark::kMillisecond);
+
+// `Classes` classes out of whitespace, line feeds, letters, digits
+static void BM_ClassCount(benchmark::State& state)
+{
+    const auto& data = text_input();
+    wc_classes cls;
+    wc_classes_init(&cls);
+    wc_classes_add(&cls, " \t\n\v\f\r", 6);
+    wc_classes_add(&cls, "\n", 1);
+    wc_classes_add(&cls, "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz", 52);
+    wc_classes_add_range(&cls, '0', '9');
+    cls.nclasses = static_cast<unsigned>(state.range(0));
+    for (auto _ : state) {
+        uint64_t counts[WC_CLASS_MAX] = {};
+        wc_classify_count(&cls, data.data(), data.size(), counts);
+        benchmark::DoNotOptimize(counts);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK(BM_ClassCount)->DenseRange(1, 4)->Unit(benchmark::kMillisecond);
+
+static void BM_Bitmaps(benchmark::State& state)
+{
+    const auto& data = text_input();
+    std::vector<uint64_t> spaces((data.size() + 63) / 64), lines(spaces.size());
+    uint64_t* bitmaps[] = { spaces.data(), lines.data() };
+    wc_classes cls;
+    wc_classes_init(&cls);
+    wc_classes_add(&cls, " \t\n\v\f\r", 6);
+    wc_classes_add(&cls, "\n", 1);
+    for (auto _ : state) {
+        wc_classify_bitmaps(&cls, data.data(), data.size(), bitmaps);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+}
+BENCHMARK(BM_Bitmaps)->Unit(benchmark::kMillisecond);
+
+template <bool Text>
+static void BM_Csv(benchmark::State& state)
+{
+    const auto& data = Text ? text_input() : csv_input();
+    wc_classes cls;
+    wc_csv_init(&cls, ',');
+    for (auto _ : state) {
+        wc_csv_counts counts = WC_CSV_COUNTS_INITIAL;
+        wc_csv_count(&cls, data.data(), data.size(), &counts);
+        benchmark::DoNotOptimize(counts);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+    state.SetLabel(Text ? "geninputs" : "csv");
+}
+BENCHMARK_TEMPLATE(BM_Csv, true)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Csv, false)->Unit(benchmark::kMillisecond);
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,38 @@
+#include <benchmark/benchmark.h>
+#include <string>
+#include "bench_inputs.h"
+#include "wc.h"
+
+// Throughput of the streaming API when the same in-memory input arrives in
+// chunks of different sizes, as it would from a log shipper's writes.
+
+static constexpr std::size_t InputSize = 64u << 20;
+
+static const std::string& input()
+{
+    static const std::string data = geninputs_text(InputSize);
+    return data;
+}
+
+template <unsigned Flags>
+static void BM_Feed(benchmark::State& state)
+{
+    const auto& data = input();
+    const auto chunk = static_cast<std::size_t>(state.range(0));
+    wc_state wc;
+    for (auto _ : state) {
+        wc_state_init(&wc, nullptr, Flags);
+        for (std::size_t i = 0; i < data.size(); i += chunk) {
+            wc_feed(&wc, data.data() + i, std::min(chunk, data.size() - i));
+        }
+        auto r = wc_finish(&wc);
+        benchmark::DoNotOptimize(r);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * data.size()));
+    state.SetLabel(wc_kernel_best()->name);
+}
+BENCHMARK_TEMPLATE(BM_Feed, 0)->RangeMultiplier(4)->Range(64, 1 << 20)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Feed, WC_UTF8)->RangeMultiplier(4)->Range(64, 1 << 20)->Unit(benchmark::kMillisecond);
+
+
+BENCHMARK_MAIN();
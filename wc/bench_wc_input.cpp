@@ -0,0 +1,88 @@
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bench_inputs.h"
+#include "wc_input.h"
+
+// Compares the wc input backends reading the same file, with the page cache
+// either warm or dropped (POSIX_FADV_DONTNEED) before every iteration. The
+// consumer only counts line feeds so the numbers are dominated by I/O.
+
+static constexpr std::size_t InputSize = 256u << 20;
+
+// geninputs.py-style text, written 1 MiB at a time
+static std::string make_input_file()
+{
+    char path[] = "/tmp/bench_wc_input.XXXXXX";
+    const int fd = mkstemp(path);
+    if (fd < 0) {
+        throw std::runtime_error("unable to create input file");
+    }
+    const std::string block = geninputs_text(1u << 20);
+    for (std::size_t n = 0; n < InputSize; n += block.size()) {
+        if (write(fd, block.data(), block.size()) != static_cast<ssize_t>(block.size())) {
+            throw std::runtime_error("unable to write input file");
+        }
+    }
+    // dirty pages can't be dropped, so make sure they are on disk
+    fsync(fd);
+    close(fd);
+    return path;
+}
+
+static const std::string& input_file()
+{
+    static const struct Input {
+        std::string path = make_input_file();
+        ~Input() { std::remove(path.c_str()); }
+    } input;
+    return input.path;
+}
+
+static int count_newlines(void* ctx, const char* buf, std::size_t len)
+{
+    *static_cast<std::size_t*>(ctx) += static_cast<std::size_t>(std::count(buf, buf + len, '\n'));
+    return 0;
+}
+
+template <wc_input_kind Kind, bool Cold>
+static void BM_Input(benchmark::State& state)
+{
+    const auto& path = input_file();
+    std::size_t lines = 0;
+    for (auto _ : state) {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            state.SkipWithError("unable to open input");
+            break;
+        }
+        if (Cold) {
+            state.PauseTiming();
+            posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+            state.ResumeTiming();
+        }
+        posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+        if (wc_input_run(Kind, fd, count_newlines, &lines) != 0) {
+            state.SkipWithError("read failed");
+        }
+        close(fd);
+    }
+    benchmark::DoNotOptimize(lines);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * InputSize));
+    state.SetLabel(wc_input_name(Kind));
+}
+BENCHMARK_TEMPLATE(BM_Input, WC_INPUT_READ   , false)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Input, WC_INPUT_BIGREAD, false)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Input, WC_INPUT_MMAP   , false)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Input, WC_INPUT_URING  , false)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Input, WC_INPUT_READ   , true )->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Input, WC_INPUT_BIGREAD, true )->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Input, WC_INPUT_MMAP   , true )->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Input, WC_INPUT_URING  , true )->Unit(benchmark::kMillisecond);
+
+
+BENCHMARK_MAIN();
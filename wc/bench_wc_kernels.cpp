@@ -0,0 +1,108 @@
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <x86intrin.h>
+#include "wc_kernel.h"
+
+// Every wc kernel this CPU supports, ASCII and UTF-8, over in-memory inputs
+// of different sizes and whitespace densities. Reports bytes/s and TSC
+// cycles per byte, so a kernel regression shows up without hand-timing the
+// binaries against geninputs.py output.
+
+// `size` bytes of text where `density` percent of the characters are
+// whitespace, one in eight of those a line feed, and `nonascii` percent of
+// the rest are multi-byte: letters from Cyrillic (2 bytes) or CJK (3 bytes)
+// and spaces U+3000, so the UTF-8 kernels leave their ASCII fast path
+static const std::string& input(std::size_t size, int density, int nonascii)
+{
+    static std::map<std::tuple<std::size_t, int, int>, std::string> inputs;
+    auto& data = inputs[{ size, density, nonascii }];
+    if (data.empty()) {
+        std::mt19937 gen(42);
+        std::uniform_int_distribution<int> percent(0, 99);
+        std::uniform_int_distribution<int> letter('a', 'z');
+        std::uniform_int_distribution<int> space(0, 7);
+        std::uniform_int_distribution<int> low6(0, 63);
+        data.reserve(size + 3);
+        while (data.size() < size) {
+            const bool multibyte = percent(gen) < nonascii;
+            if (percent(gen) < density) {
+                if (space(gen) == 0) {
+                    data += '\n';
+                } else if (multibyte) {
+                    data += "\xe3\x80\x80";
+                } else {
+                    data += ' ';
+                }
+            } else if (!multibyte) {
+                data += static_cast<char>(letter(gen));
+            } else if (percent(gen) < 50) {
+                // U+0430..U+044F
+                const int c = 0x430 + low6(gen) % 32;
+                data += static_cast<char>(0xc0 | (c >> 6));
+                data += static_cast<char>(0x80 | (c & 0x3f));
+            } else {
+                // U+4E00..U+4FFF
+                const int c = 0x4e00 + low6(gen) * 8;
+                data += static_cast<char>(0xe0 | (c >> 12));
+                data += static_cast<char>(0x80 | ((c >> 6) & 0x3f));
+                data += static_cast<char>(0x80 | (c & 0x3f));
+            }
+        }
+        data.resize(size);
+    }
+    return data;
+}
+
+static void BM_Kernel(benchmark::State& state, wc_count_fn count)
+{
+    const auto& data = input(static_cast<std::size_t>(state.range(0)), static_cast<int>(state.range(1)),
+                             static_cast<int>(state.range(2)));
+    uint64_t cycles = 0;
+    for (auto _ : state) {
+        wc_counts counts = WC_COUNTS_INITIAL;
+        const uint64_t start = __rdtsc();
+        count(data.data(), data.size(), &counts);
+        cycles += __rdtsc() - start;
+        benchmark::DoNotOptimize(counts);
+    }
+    const auto bytes = static_cast<double>(state.iterations()) * static_cast<double>(data.size());
+    state.SetBytesProcessed(static_cast<int64_t>(bytes));
+    state.counters["cycles/byte"] = static_cast<double>(cycles) / bytes;
+}
+
+static void register_kernels()
+{
+    for (std::size_t i = 0; i < wc_nkernels; ++i) {
+        const wc_kernel& kernel = wc_kernels[i];
+        if (!wc_kernel_supported(&kernel)) {
+            continue;
+        }
+        for (bool utf8 : { false, true }) {
+            const std::string name = std::string("BM_Kernel/") + kernel.name + (utf8 ? "/utf8" : "");
+            // the ASCII kernels only see bytes, so non-ASCII text is no
+            // different for them
+            benchmark::RegisterBenchmark(name.c_str(), BM_Kernel, utf8 ? kernel.count_utf8 : kernel.count)
+                ->ArgNames({ "size", "ws%", "nonascii%" })
+                ->ArgsProduct({ { 4 << 10, 256 << 10, 16 << 20 }, { 2, 15, 50 },
+                                utf8 ? std::vector<int64_t>{ 0, 10, 100 } : std::vector<int64_t>{ 0 } });
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    register_kernels();
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
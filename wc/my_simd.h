@@ -1,12 +1,81 @@
+#ifndef MY_SIMD_H
+#define MY_SIMD_H
 
+#include <stdio.h>
+#include <stdint.h>
 #include <immintrin.h>
 #include <nmmintrin.h>
+
+/*
+ * One `simd_*` vocabulary over three instruction sets, chosen by the flags the
+ * including file is compiled with (see the wc_kernel_<isa>.c files):
+ *
+ *   SIMD_WIDTH      bytes per simd_vector
+ *   simd_mask       result of a byte compare: a vector of 0/-1 bytes, or a
+ *                   k-mask register on AVX-512 (SIMD_KMASK is then defined)
+ *   simd_imask      one bit per byte, as from movemask
+ *   simd_broadcast16  16 bytes at p repeated in every 128-bit lane, for pshufb
+ *   simd_shln_from_i8 a shifted up by n bytes (n <= 16, a constant), the
+ *                   last n bytes of b shifted in; the bytes before each of a's
+ *   simd_testz      whether every byte of a is zero
+ */
+
+#if defined(__AVX512BW__)
+
+static inline void description()
+{
+	printf("Using AVX-512BW\n");
+}
+#define SIMD_WIDTH                64
+#define SIMD_KMASK                1
+#define simd_vector_from_mask(a)  _mm512_movm_epi8(a)
+#define simd_imask_from_mask(a)   ((simd_imask)(a))
+#define simd_set_i8(a)            _mm512_set1_epi8(a)
+#define simd_setzero()            _mm512_setzero_si512()
+#define simd_cmpeq_i8(a, b)       simd_vector_from_mask(_mm512_cmpeq_epi8_mask((a), (b)))
+#define simd_andnot_i8(a, b)      _mm512_andnot_si512((a), (b))
+#define simd_add_i64(a, b)        _mm512_add_epi64((a), (b))
+#define simd_sub_i8(a, b)         _mm512_sub_epi8((a), (b))
+#define simd_sad_u8(a, b)         _mm512_sad_epu8((a), (b))
+#define simd_imask_popcnt(a)      _mm_popcnt_u64(a)
+#define simd_cmpeq_i8_mask(a, b)  _mm512_cmpeq_epi8_mask((a), (b))
+#define simd_cmpgt_i8_mask(a, b)  _mm512_cmpgt_epi8_mask((a), (b))
+#define simd_cmpws_i8_mask(a)     simd_cmpws_i8(a)
+#define simd_store(a, b)          _mm512_store_si512((a), (b))
+#define simd_loadu(p)             _mm512_loadu_si512((const void *)(p))
+#define simd_and(a, b)            _mm512_and_si512((a), (b))
+#define simd_shuffle_i8(a, b)     _mm512_shuffle_epi8((a), (b))
+#define simd_srli_i16(a, n)       _mm512_srli_epi16((a), (n))
+#define simd_broadcast16(p)       _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i *)(p)))
+#define simd_or(a, b)             _mm512_or_si512((a), (b))
+#define simd_xor(a, b)            _mm512_xor_si512((a), (b))
+#define simd_subs_u8(a, b)        _mm512_subs_epu8((a), (b))
+#define simd_testz(a)             (_mm512_test_epi8_mask((a), (a)) == 0)
+#define simd_shln_from_i8(a, b, n) \
+	_mm512_alignr_epi8((a), _mm512_alignr_epi64((a), (b), 6), 16 - (n))
+typedef __m512i simd_vector;
+typedef uint64_t simd_imask;
+typedef __mmask64 simd_mask;
+static inline simd_mask simd_cmpws_i8(simd_vector a)
+{
+	simd_vector shuffle_src = _mm512_set_epi64(0x0d0c0b0a0900, 0x20,
+	                                           0x0d0c0b0a0900, 0x20,
+	                                           0x0d0c0b0a0900, 0x20,
+	                                           0x0d0c0b0a0900, 0x20);
+	return _mm512_cmpeq_epi8_mask(_mm512_shuffle_epi8(shuffle_src, a), a);
+}
+// no simd_shl1_from_i8: with k-masks the shift is done on the simd_imask
+// endif AVX-512BW
+
+#elif defined(__AVX2__)
+
 static inline void description()
 {
-    printf("Using AVX2\n");
+	printf("Using AVX2\n");
 }
+#define SIMD_WIDTH                32
 #define simd_vector_from_mask(a)  (a)
-#define simd_imask_from_mask(a)   _mm256_movemask_epi8(a)
+#define simd_imask_from_mask(a)   ((simd_imask)_mm256_movemask_epi8(a))
 #define simd_set_i8(a)            _mm256_set1_epi8(a)
 #define simd_setzero()            _mm256_setzero_si256()
 #define simd_cmpeq_i8(a, b)       _mm256_cmpeq_epi8((a), (b))
@@ -16,8 +85,20 @@ static inline void description()
 #define simd_sad_u8(a, b)         _mm256_sad_epu8((a), (b))
 #define simd_imask_popcnt(a)      _mm_popcnt_u32(a)
 #define simd_cmpeq_i8_mask(a, b)  simd_cmpeq_i8((a), (b))
+#define simd_cmpgt_i8_mask(a, b)  _mm256_cmpgt_epi8((a), (b))
 #define simd_cmpws_i8_mask(a)     simd_cmpws_i8(a)
 #define simd_store(a, b)          _mm256_store_si256((a), (b))
+#define simd_loadu(p)             _mm256_loadu_si256((const __m256i *)(p))
+#define simd_and(a, b)            _mm256_and_si256((a), (b))
+#define simd_shuffle_i8(a, b)     _mm256_shuffle_epi8((a), (b))
+#define simd_srli_i16(a, n)       _mm256_srli_epi16((a), (n))
+#define simd_broadcast16(p)       _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(p)))
+#define simd_or(a, b)             _mm256_or_si256((a), (b))
+#define simd_xor(a, b)            _mm256_xor_si256((a), (b))
+#define simd_subs_u8(a, b)        _mm256_subs_epu8((a), (b))
+#define simd_testz(a)             _mm256_testz_si256((a), (a))
+#define simd_shln_from_i8(a, b, n) \
+	_mm256_alignr_epi8((a), _mm256_permute2x128_si256((b), (a), 0x21), 16 - (n))
 typedef __m256i simd_vector;
 typedef uint32_t simd_imask;
 typedef simd_vector simd_mask;
@@ -33,3 +114,55 @@ static inline simd_vector simd_shl1_from_i8(simd_vector a, simd_vector b)
 	return _mm256_alignr_epi8(a, _mm256_permute2x128_si256(b, a, 0x21), 15);
 }
 // endif AVX2
+
+#elif defined(__SSE4_2__)
+
+static inline void description()
+{
+	printf("Using SSE4.2\n");
+}
+#define SIMD_WIDTH                16
+#define simd_vector_from_mask(a)  (a)
+#define simd_imask_from_mask(a)   ((simd_imask)_mm_movemask_epi8(a))
+#define simd_set_i8(a)            _mm_set1_epi8(a)
+#define simd_setzero()            _mm_setzero_si128()
+#define simd_cmpeq_i8(a, b)       _mm_cmpeq_epi8((a), (b))
+#define simd_andnot_i8(a, b)      _mm_andnot_si128((a), (b))
+#define simd_add_i64(a, b)        _mm_add_epi64((a), (b))
+#define simd_sub_i8(a, b)         _mm_sub_epi8((a), (b))
+#define simd_sad_u8(a, b)         _mm_sad_epu8((a), (b))
+#define simd_imask_popcnt(a)      _mm_popcnt_u32(a)
+#define simd_cmpeq_i8_mask(a, b)  simd_cmpeq_i8((a), (b))
+#define simd_cmpgt_i8_mask(a, b)  _mm_cmpgt_epi8((a), (b))
+#define simd_cmpws_i8_mask(a)     simd_cmpws_i8(a)
+#define simd_store(a, b)          _mm_store_si128((a), (b))
+#define simd_loadu(p)             _mm_loadu_si128((const __m128i *)(p))
+#define simd_and(a, b)            _mm_and_si128((a), (b))
+#define simd_shuffle_i8(a, b)     _mm_shuffle_epi8((a), (b))
+#define simd_srli_i16(a, n)       _mm_srli_epi16((a), (n))
+#define simd_broadcast16(p)       _mm_loadu_si128((const __m128i *)(p))
+#define simd_or(a, b)             _mm_or_si128((a), (b))
+#define simd_xor(a, b)            _mm_xor_si128((a), (b))
+#define simd_subs_u8(a, b)        _mm_subs_epu8((a), (b))
+#define simd_testz(a)             _mm_testz_si128((a), (a))
+#define simd_shln_from_i8(a, b, n) _mm_alignr_epi8((a), (b), 16 - (n))
+typedef __m128i simd_vector;
+typedef uint32_t simd_imask;
+typedef simd_vector simd_mask;
+static inline simd_vector simd_cmpws_i8(simd_vector a)
+{
+	simd_vector shuffle_src = _mm_set_epi64x(0x0d0c0b0a0900, 0x20);
+	return simd_cmpeq_i8(_mm_shuffle_epi8(shuffle_src, a), a);
+}
+// shift a left by 1 byte, shifting in byte from the end of b
+static inline simd_vector simd_shl1_from_i8(simd_vector a, simd_vector b)
+{
+	return _mm_alignr_epi8(a, b, 15);
+}
+// endif SSE4.2
+
+#else
+#error "my_simd.h needs at least SSE4.2"
+#endif
+
+#endif
@@ -0,0 +1,63 @@
+#include "wc.h"
+#include <string.h>
+
+void wc_state_init(wc_state *state, const wc_kernel *kernel, unsigned flags)
+{
+	const wc_counts initial = WC_COUNTS_INITIAL;
+
+	if (!kernel)
+		kernel = wc_kernel_best();
+	state->count  = (flags & WC_UTF8) ? kernel->count_utf8 : kernel->count;
+	state->flags  = flags;
+	state->counts = initial;
+	state->bytes  = 0;
+	state->nstage = 0;
+}
+
+static void flush_stage(wc_state *state)
+{
+	if (state->nstage) {
+		state->count(state->stage, state->nstage, &state->counts);
+		state->nstage = 0;
+	}
+}
+
+void wc_feed(wc_state *state, const void *p, size_t len)
+{
+	const char *s = p;
+
+	state->bytes += len;
+	if (len >= WC_STAGE_MIN) {
+		// the kernels carry their state between calls, so big chunks are
+		// counted in place once the staged bytes before them are done
+		flush_stage(state);
+		state->count(s, len, &state->counts);
+		return;
+	}
+	while (len) {
+		size_t n = WC_STAGE_SIZE - state->nstage;
+		if (n > len)
+			n = len;
+		memcpy(state->stage + state->nstage, s, n);
+		state->nstage += n;
+		s   += n;
+		len -= n;
+		if (state->nstage == WC_STAGE_SIZE)
+			flush_stage(state);
+	}
+}
+
+wc_result wc_finish(wc_state *state)
+{
+	wc_result r;
+
+	flush_stage(state);
+	if (state->flags & WC_UTF8)
+		wc_count_utf8_finish(&state->counts);
+	r.lines   = state->counts.lines;
+	r.words   = state->counts.words;
+	r.bytes   = state->bytes;
+	r.chars   = state->counts.chars;
+	r.invalid = state->counts.invalid;
+	return r;
+}
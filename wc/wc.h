@@ -0,0 +1,62 @@
+#ifndef WC_H
+#define WC_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "wc_kernel.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Streaming word/line counter for embedding: feed it a stream in chunks of
+ * any size and alignment, then call wc_finish() once. A wc_state owns no heap
+ * memory, so it can live on the stack or inside another struct.
+ *
+ *     wc_state st;
+ *     wc_state_init(&st, NULL, 0);
+ *     while ((n = read(fd, buf, sizeof(buf))) > 0)
+ *         wc_feed(&st, buf, (size_t)n);
+ *     wc_result r = wc_finish(&st);
+ *
+ * Chunks shorter than WC_STAGE_MIN are copied into a small staging buffer
+ * and counted WC_STAGE_SIZE bytes at a time, so tiny writes still get the
+ * vector kernels instead of their scalar tails.
+ */
+#define WC_STAGE_SIZE 4096
+#define WC_STAGE_MIN  512
+
+enum {
+	WC_UTF8 = 1 << 0, /* also count characters, Unicode spaces separate words */
+};
+
+typedef struct {
+	uint64_t lines, words, bytes;
+	uint64_t chars, invalid; /* WC_UTF8 only */
+} wc_result;
+
+typedef struct {
+	wc_count_fn count;
+	unsigned flags;
+	wc_counts counts;
+	uint64_t bytes;
+	size_t nstage;
+	char stage[WC_STAGE_SIZE] __attribute__((aligned(64)));
+} wc_state;
+
+/* `kernel` is NULL for the fastest one this CPU supports. */
+void wc_state_init(wc_state *state, const wc_kernel *kernel, unsigned flags);
+
+void wc_feed(wc_state *state, const void *p, size_t len);
+
+/* Counts whatever is still staged and returns the totals; `state` has to be
+ * initialized again before it's reused. */
+wc_result wc_finish(wc_state *state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,263 +8,368 @@
 #include <string.h>
 #include <errno.h>
 #include <ctype.h>
-#include <immintrin.h>
-#include <emmintrin.h>
-#include <nmmintrin.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <getopt.h>
+#include "wc_input.h"
+#include "wc_kernel.h"
+#include "wc.h"
 
-#define popcnt __builtin_popcount
-#define BUFSIZE 4096
-#define simd_vector_from_mask(a)  (a)
-#define simd_imask_from_mask(a)   _mm256_movemask_epi8(a)
-#define simd_set_i8(a)            _mm256_set1_epi8(a)
-#define simd_setzero()            _mm256_setzero_si256()
-#define simd_cmpeq_i8(a, b)       _mm256_cmpeq_epi8((a), (b))
-#define simd_andnot_i8(a, b)      _mm256_andnot_si256((a), (b))
-#define simd_add_i64(a, b)        _mm256_add_epi64((a), (b))
-#define simd_sub_i8(a, b)         _mm256_sub_epi8((a), (b))
-#define simd_sad_u8(a, b)         _mm256_sad_epu8((a), (b))
-#define simd_imask_popcnt(a)      _mm_popcnt_u32(a)
-#define simd_cmpeq_i8_mask(a, b)  simd_cmpeq_i8((a), (b))
-// #define simd_cmpws_i8_mask(a)     simd_cmpws_i8(a)
-#define simd_store(a, b)          _mm256_store_si256((a), (b))
-typedef __m256i simd_vector;
-typedef uint32_t simd_imask;
-typedef simd_vector simd_mask;
-static inline __m256i simd_cmpws_i8_mask(__m256i a)
-{
-    __m256i shuffle_src = _mm256_set_epi64x(
-                0x0d0c0b0a0900,
-                0x20,
-                0x0d0c0b0a0900,
-                0x20
-            );
-	return simd_cmpeq_i8(_mm256_shuffle_epi8(shuffle_src, a), a);
-}
-// shift a left by 1 byte, shifting in byte from the end of b
-static inline __m256i simd_shl1_from_i8(__m256i a, __m256i b)
+#define CHUNKSIZE   (8u << 20) // bytes per piece of a split file in parallel mode
+#define BATCH_BYTES (1u << 20) // small files are batched into jobs of about this
+#define BATCH_FILES 32         // much data, or this many files
+
+static const wc_kernel *kernel;
+static bool count_utf8; // -m: UTF-8 characters and Unicode spaces
+
+static int count_input(void *arg, const char *p, size_t len)
 {
-	return _mm256_alignr_epi8(a, _mm256_permute2x128_si256(b, a, 0x21), 15);
+	wc_feed(arg, p, len);
+	return 0;
 }
 
-typedef struct {
-	__m256i vcount, count;
-	uint8_t iterations;
-} lcount_state;
-typedef struct {
-	__m256i vcount, count, prev_eqws;
-	uint8_t iterations;
-} wcount_state;
-#define LCOUNT_INITIAL \
-	(lcount_state){ simd_setzero(), simd_setzero(), 0 }
-#define WCOUNT_INITIAL \
-	(wcount_state){ simd_setzero(), simd_setzero(), simd_set_i8(-1), 0 }
-#define WCOUNT_CONTINUE \
-	(wcount_state){ simd_setzero(), simd_setzero(), simd_setzero(), 0 }
-
-static inline void wcount_state_set(wcount_state *state, bool wcontinue)
+static void print_counts(const wc_result *r, const char *filename)
 {
-	state->prev_eqws = wcontinue ? simd_setzero() : simd_set_i8(-1);
+	if (!count_utf8)
+		printf(" %7zu %7zu %7zu %s\n", (size_t)r->lines, (size_t)r->words,
+		       (size_t)r->bytes, filename);
+	else
+		printf(" %7zu %7zu %7zu %7zu %s\n", (size_t)r->lines, (size_t)r->words,
+		       (size_t)r->chars, (size_t)r->bytes, filename);
+	if (r->invalid)
+		fprintf(stderr, "warning: %s: %zu invalid UTF-8 sequences\n", filename,
+		        (size_t)r->invalid);
 }
 
-static inline uint64_t count_lines_final(lcount_state *state)
+static void add_counts(wc_result *total, const wc_result *r)
 {
-	state->count = simd_add_i64(state->count,
-	                            simd_sad_u8(state->vcount, simd_setzero()));
-	state->vcount = simd_setzero();
-	uint64_t sum = 0;
-	union {
-		__m256i vec;
-		uint64_t u64[sizeof(__m256i)/sizeof(uint64_t)];
-	} unpack;
-	simd_store(&unpack.vec, state->count);
-	for (int i = 0; i != sizeof(__m256i)/sizeof(uint64_t); ++i)
-		sum += unpack.u64[i];
-	return sum;
+	total->lines   += r->lines;
+	total->words   += r->words;
+	total->bytes   += r->bytes;
+	total->chars   += r->chars;
+	total->invalid += r->invalid;
 }
 
-static inline uint64_t count_words_final(wcount_state *state)
+static int count_fd(int fd, wc_input_kind input, wc_result *r)
 {
-	state->count = simd_add_i64(state->count,
-	                            simd_sad_u8(state->vcount, simd_setzero()));
-	state->vcount = simd_setzero();
-	uint64_t sum = 0;
-	union {
-		__m256i vec;
-		uint64_t u64[4];
-	} unpack;
-	simd_store(&unpack.vec, state->count);
-	for (int i = 0; i != 4; ++i)
-		sum += unpack.u64[i];
-	return sum;
+	wc_state state;
+
+	wc_state_init(&state, kernel, count_utf8 ? WC_UTF8 : 0);
+	if (wc_input_run(input, fd, count_input, &state) != 0)
+		return -1;
+	*r = wc_finish(&state);
+	return 0;
 }
 
-static inline int count_lines(__m256i vec, lcount_state *state)
+int process(int fd, const char* filename, wc_input_kind input, wc_result *total)
 {
-	__m256i is_line_feed = simd_cmpeq_i8(vec, simd_set_i8('\n'));
-	// is_line_feed has a value of -1 for line feeds, 0 otherwise
-	state->vcount = simd_sub_i8(state->vcount, is_line_feed);
-	state->iterations++;
-	if (state->iterations == 255) {
-		// sum line feed position counts before they can overflow
-		state->count = simd_add_i64(state->count,
-		                            simd_sad_u8(state->vcount, simd_setzero()));
-		state->vcount = simd_setzero();
-		state->iterations = 0;
+	wc_result r;
+
+	if (count_fd(fd, input, &r) != 0) {
+		perror("fastlwc: read");
+		exit(EXIT_FAILURE);
 	}
+	print_counts(&r, filename);
+	add_counts(total, &r);
 	return 0;
 }
 
-static inline int count_words_wsmask(simd_mask eqmask, wcount_state *state)
+int run_file(const char* filename, wc_input_kind input, wc_result *total)
 {
-	simd_vector eqws = simd_vector_from_mask(eqmask),
-	            andmsk = simd_shl1_from_i8(eqws, state->prev_eqws),
-	            is_first_char = simd_andnot_i8(eqws, andmsk);
-	state->prev_eqws = eqws;
-	// is_first_char has a value of -1 for word starting characters, 0 otherwise
-	state->vcount = simd_sub_i8(state->vcount, is_first_char);
-	state->iterations++;
-	if (state->iterations == 255) {
-		// sum first character position counts before they can overflow
-		state->count = simd_add_i64(state->count,
-		                            simd_sad_u8(state->vcount, simd_setzero()));
-		state->vcount = simd_setzero();
-		state->iterations = 0;
-	}
-	return 0;
+    int rc;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "error: unable to open input: %s\n", filename);
+        return 1;
+    }
+	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+	rc = process(fd, filename, input, total);
+    close(fd);
+    return rc;
 }
 
-static inline int count_words(simd_vector vec, wcount_state *state)
+/*
+ * Parallel mode (-j): every file becomes one or more pieces. Files bigger
+ * than CHUNKSIZE are split into CHUNKSIZE pieces, each counted as if it were
+ * preceded by whitespace; a word straddling two pieces is then counted twice,
+ * so stitching subtracts one for every boundary where the last byte of a
+ * piece and the first byte of the next are both non-space. Everything else
+ * (and every file with -m, as splitting would cut characters) is one whole
+ * piece, counted with the -i backend.
+ *
+ * Jobs are runs of pieces: one piece of a split file, or a batch of small
+ * files, so their open/read overhead is overlapped across the workers. The
+ * jobs are dealt out in contiguous ranges, one per worker, and a worker that
+ * runs out of its own claims the next job of another's range.
+ */
+typedef struct {
+	size_t file;
+	off_t off;
+	size_t len;
+	bool whole;
+
+	wc_result r;
+	bool first_ws, last_ws, failed;
+} piece;
+
+typedef struct {
+	atomic_size_t next;
+	size_t end;
+	char pad[64 - sizeof(atomic_size_t) - sizeof(size_t)];
+} job_queue;
+
+typedef struct {
+	char **paths;
+	piece *pieces;
+	size_t *jobs; // job j is pieces [jobs[j], jobs[j + 1])
+	size_t njobs;
+	job_queue *queues;
+	int nworkers;
+	wc_input_kind input;
+} job_pool;
+
+typedef struct {
+	job_pool *pool;
+	int id;
+} worker_arg;
+
+static bool claim(job_queue *q, size_t *job)
 {
-	return count_words_wsmask(simd_cmpws_i8_mask(vec), state);
+	if (atomic_load_explicit(&q->next, memory_order_relaxed) >= q->end)
+		return false;
+	*job = atomic_fetch_add(&q->next, 1);
+	return *job < q->end;
 }
 
-int process(int fd, const char* filename)
+static void count_piece(job_pool *pool, piece *pc, char *buf, int *fd, size_t *fd_file)
 {
+	wc_counts counts = WC_COUNTS_INITIAL;
+	size_t have = 0;
 
-    __m256i *buf = aligned_alloc(sizeof(__m256i), BUFSIZE);
-	ssize_t len;
-	size_t lcount = 0, wcount = 0, ccount = 0, rem = 0;
-	lcount_state lstate = {
-        .vcount = simd_setzero(),
-        .count = simd_setzero(),
-        .iterations = 0,
-    };
-	wcount_state wstate = {
-        .vcount = simd_setzero(),
-        .count = simd_setzero(),
-        .prev_eqws = simd_set_i8(-1),
-        .iterations = 0
-    };
-
-    while ((len = read(fd, (char*)buf + rem, BUFSIZE - rem)) > 0) {
-		rem += len;
-		ccount += len;
-		__m256i *vp = buf;
-		while (rem >= sizeof(__m256i)) {
-			lcount += count_lines(*vp, &lstate);
-			wcount += count_words(*vp, &wstate);
-			rem -= sizeof(__m256i);
-			vp++;
+	// consecutive pieces of a split file mostly go to the same worker
+	if (*fd < 0 || *fd_file != pc->file) {
+		if (*fd >= 0)
+			close(*fd);
+		*fd = open(pool->paths[pc->file], O_RDONLY);
+		*fd_file = pc->file;
+		if (*fd < 0) {
+			pc->failed = true;
+			return;
 		}
-        memmove(buf, vp, rem);
-    }
+	}
+	if (pc->whole) {
+		pc->failed = count_fd(*fd, pool->input, &pc->r) != 0;
+		close(*fd);
+		*fd = -1;
+		return;
+	}
+	while (have < pc->len) {
+		ssize_t n = pread(*fd, buf + have, pc->len - have, pc->off + (off_t)have);
+		if (n <= 0) {
+			if (n < 0 && errno == EINTR)
+				continue;
+			pc->failed = true;
+			return;
+		}
+		have += (size_t)n;
+	}
+	kernel->count(buf, have, &counts);
+	pc->r.lines = counts.lines;
+	pc->r.words = counts.words;
+	pc->r.bytes = have;
+	pc->first_ws = have == 0 || wc_isspace(buf[0]);
+	pc->last_ws  = counts.prev_ws;
+}
 
-    if (len < 0) {
-        perror("fastlwc: read");
-        exit(EXIT_FAILURE);
-    }
+static void *pool_worker(void *arg)
+{
+	job_pool *pool = ((worker_arg *)arg)->pool;
+	const int id = ((worker_arg *)arg)->id;
+	char *buf = aligned_alloc(64, CHUNKSIZE);
+	int fd = -1;
+	size_t fd_file = 0, job;
 
-	if (rem) {
-		memset((char*)buf + rem, ' ', sizeof(__m256i) - rem);
-		__m256i *vp = buf;
-		lcount += count_lines(*vp, &lstate);
-		wcount += count_words(*vp, &wstate);
+	for (int v = 0; v < pool->nworkers; ++v) {
+		job_queue *q = &pool->queues[(id + v) % pool->nworkers];
+		while (claim(q, &job)) {
+			for (size_t i = pool->jobs[job]; i < pool->jobs[job + 1]; ++i) {
+				if (buf)
+					count_piece(pool, &pool->pieces[i], buf, &fd, &fd_file);
+				else
+					pool->pieces[i].failed = true;
+			}
+		}
 	}
+	if (fd >= 0)
+		close(fd);
+	free(buf);
+	return NULL;
+}
 
-	lcount += count_lines_final(&lstate);
-	wcount += count_words_final(&wstate);
+/* Splits the files into pieces and the pieces into jobs. */
+static void plan_jobs(job_pool *pool, size_t nfiles, size_t *npieces)
+{
+	size_t n = 0, cap = nfiles, batch_bytes = 0, batch_files = 0;
+	struct stat st;
 
-	printf(" %7zu %7zu %7zu %s\n", lcount, wcount, ccount, filename);
-    free(buf);
+	pool->pieces = malloc(cap * sizeof(pool->pieces[0]));
+	pool->jobs = malloc((cap + 1) * sizeof(pool->jobs[0]));
+	pool->njobs = 0;
+	for (size_t f = 0; f < nfiles; ++f) {
+		const bool regular = stat(pool->paths[f], &st) == 0 && S_ISREG(st.st_mode);
+		const size_t size = regular ? (size_t)st.st_size : BATCH_BYTES;
+		const size_t count = regular && !count_utf8 && size > CHUNKSIZE ?
+		                     (size + CHUNKSIZE - 1) / CHUNKSIZE : 1;
 
-    return 0;
+		if (n + count > cap) {
+			cap = 2 * (n + count);
+			pool->pieces = realloc(pool->pieces, cap * sizeof(pool->pieces[0]));
+			pool->jobs = realloc(pool->jobs, (cap + 1) * sizeof(pool->jobs[0]));
+		}
+		if (!pool->pieces || !pool->jobs) {
+			perror("fastlwc: malloc");
+			exit(EXIT_FAILURE);
+		}
+		for (size_t i = 0; i < count; ++i, ++n) {
+			piece *pc = &pool->pieces[n];
+			memset(pc, 0, sizeof(*pc));
+			pc->file  = f;
+			pc->off   = (off_t)(i * CHUNKSIZE);
+			pc->len   = size - i * CHUNKSIZE < CHUNKSIZE ? size - i * CHUNKSIZE : CHUNKSIZE;
+			pc->whole = count == 1;
+			if (!pc->whole) {
+				pool->jobs[pool->njobs++] = n;
+				batch_bytes = batch_files = 0;
+				continue;
+			}
+			if (batch_files == 0)
+				pool->jobs[pool->njobs++] = n;
+			batch_bytes += size;
+			if (++batch_files == BATCH_FILES || batch_bytes >= BATCH_BYTES)
+				batch_bytes = batch_files = 0;
+		}
+	}
+	pool->jobs[pool->njobs] = n;
+	*npieces = n;
 }
 
-int run_file(const char* filename)
+int process_parallel(char **paths, size_t nfiles, int nthreads, wc_input_kind input)
 {
-    int rc;
-    int fd = open(filename, O_RDONLY);
-    if (fd < 0) {
-        fprintf(stderr, "error: unable to open input: %s\n", filename);
-        return 1;
-    }
-	posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
-    rc = process(fd, filename);
-    close(fd);
-    return rc;
+	job_pool pool = { .paths = paths, .input = input };
+	wc_result total = { 0, 0, 0, 0, 0 };
+	pthread_t *threads;
+	worker_arg *args;
+	size_t npieces, p = 0;
+	int started = 0, rc = 0;
+
+	plan_jobs(&pool, nfiles, &npieces);
+	if ((size_t)nthreads > pool.njobs)
+		nthreads = pool.njobs > 0 ? (int)pool.njobs : 1;
+	pool.nworkers = nthreads;
+	pool.queues = calloc((size_t)nthreads, sizeof(pool.queues[0]));
+	threads = calloc((size_t)nthreads, sizeof(threads[0]));
+	args = calloc((size_t)nthreads, sizeof(args[0]));
+	if (!pool.queues || !threads || !args) {
+		perror("fastlwc: calloc");
+		exit(EXIT_FAILURE);
+	}
+	for (int w = 0; w < nthreads; ++w) {
+		atomic_init(&pool.queues[w].next, pool.njobs * (size_t)w / (size_t)nthreads);
+		pool.queues[w].end = pool.njobs * (size_t)(w + 1) / (size_t)nthreads;
+		args[w].pool = &pool;
+		args[w].id = w;
+	}
+
+	for (; started < nthreads; ++started) {
+		if (pthread_create(&threads[started], NULL, pool_worker, &args[started]) != 0)
+			break;
+	}
+	if (started == 0)
+		pool_worker(&args[0]);
+	for (int i = 0; i < started; ++i)
+		pthread_join(threads[i], NULL);
+
+	// stitch the pieces of every file back together, in argument order
+	for (size_t f = 0; f < nfiles; ++f) {
+		wc_result r = { 0, 0, 0, 0, 0 };
+		bool failed = false;
+		for (size_t first = p; p < npieces && pool.pieces[p].file == f; ++p) {
+			const piece *pc = &pool.pieces[p];
+			failed |= pc->failed;
+			add_counts(&r, &pc->r);
+			if (p > first && !pool.pieces[p - 1].last_ws && !pc->first_ws)
+				--r.words;
+		}
+		if (failed) {
+			fprintf(stderr, "error: unable to read input: %s\n", paths[f]);
+			rc = 1;
+			continue;
+		}
+		print_counts(&r, paths[f]);
+		add_counts(&total, &r);
+	}
+	if (nfiles > 1)
+		print_counts(&total, "total");
+
+	free(args);
+	free(threads);
+	free(pool.queues);
+	free(pool.jobs);
+	free(pool.pieces);
+	return rc;
 }
 
 int main(int argc, char** argv)
 {
-    const char *ss = "This is\nan example\tsentence.\rabd";
-    __m256i *buf = aligned_alloc(sizeof(__m256i), BUFSIZE);
-    memcpy(buf, ss, strlen(ss));
-
-    __m256i shuffle_src = _mm256_set_epi64x(
-                0x0d0c0b0a0900,
-                0x20,
-                0x0d0c0b0a0900,
-                0x20
-            );
-    __m256i v = *buf;
-    __m256i a = _mm256_shuffle_epi8(shuffle_src, v);
-    __m256i b = _mm256_cmpeq_epi8(a, v);
-
-    printf("[%2d] %c %3d %3d\n",  0, (char)_mm256_extract_epi8(v,  0), _mm256_extract_epi8(a,  0), _mm256_extract_epi8(b,  0));
-    printf("[%2d] %c %3d %3d\n",  1, (char)_mm256_extract_epi8(v,  1), _mm256_extract_epi8(a,  1), _mm256_extract_epi8(b,  1));
-    printf("[%2d] %c %3d %3d\n",  2, (char)_mm256_extract_epi8(v,  2), _mm256_extract_epi8(a,  2), _mm256_extract_epi8(b,  2));
-    printf("[%2d] %c %3d %3d\n",  3, (char)_mm256_extract_epi8(v,  3), _mm256_extract_epi8(a,  3), _mm256_extract_epi8(b,  3));
-    printf("[%2d] %c %3d %3d\n",  4, (char)_mm256_extract_epi8(v,  4), _mm256_extract_epi8(a,  4), _mm256_extract_epi8(b,  4));
-    printf("[%2d] %c %3d %3d\n",  5, (char)_mm256_extract_epi8(v,  5), _mm256_extract_epi8(a,  5), _mm256_extract_epi8(b,  5));
-    printf("[%2d] %c %3d %3d\n",  6, (char)_mm256_extract_epi8(v,  6), _mm256_extract_epi8(a,  6), _mm256_extract_epi8(b,  6));
-    printf("[%2d] %c %3d %3d\n",  7, (char)_mm256_extract_epi8(v,  7), _mm256_extract_epi8(a,  7), _mm256_extract_epi8(b,  7));
-    printf("[%2d] %c %3d %3d\n",  8, (char)_mm256_extract_epi8(v,  8), _mm256_extract_epi8(a,  8), _mm256_extract_epi8(b,  8));
-    printf("[%2d] %c %3d %3d\n",  9, (char)_mm256_extract_epi8(v,  9), _mm256_extract_epi8(a,  9), _mm256_extract_epi8(b,  9));
-    printf("[%2d] %c %3d %3d\n", 10, (char)_mm256_extract_epi8(v, 10), _mm256_extract_epi8(a, 10), _mm256_extract_epi8(b, 10));
-    printf("[%2d] %c %3d %3d\n", 11, (char)_mm256_extract_epi8(v, 11), _mm256_extract_epi8(a, 11), _mm256_extract_epi8(b, 11));
-    printf("[%2d] %c %3d %3d\n", 12, (char)_mm256_extract_epi8(v, 12), _mm256_extract_epi8(a, 12), _mm256_extract_epi8(b, 12));
-    printf("[%2d] %c %3d %3d\n", 13, (char)_mm256_extract_epi8(v, 13), _mm256_extract_epi8(a, 13), _mm256_extract_epi8(b, 13));
-    printf("[%2d] %c %3d %3d\n", 14, (char)_mm256_extract_epi8(v, 14), _mm256_extract_epi8(a, 14), _mm256_extract_epi8(b, 14));
-    printf("[%2d] %c %3d %3d\n", 15, (char)_mm256_extract_epi8(v, 15), _mm256_extract_epi8(a, 15), _mm256_extract_epi8(b, 15));
-    printf("[%2d] %c %3d %3d\n", 16, (char)_mm256_extract_epi8(v, 16), _mm256_extract_epi8(a, 16), _mm256_extract_epi8(b, 16));
-    printf("[%2d] %c %3d %3d\n", 17, (char)_mm256_extract_epi8(v, 17), _mm256_extract_epi8(a, 17), _mm256_extract_epi8(b, 17));
-    printf("[%2d] %c %3d %3d\n", 18, (char)_mm256_extract_epi8(v, 18), _mm256_extract_epi8(a, 18), _mm256_extract_epi8(b, 18));
-    printf("[%2d] %c %3d %3d\n", 19, (char)_mm256_extract_epi8(v, 19), _mm256_extract_epi8(a, 19), _mm256_extract_epi8(b, 19));
-    printf("[%2d] %c %3d %3d\n", 20, (char)_mm256_extract_epi8(v, 20), _mm256_extract_epi8(a, 20), _mm256_extract_epi8(b, 20));
-    printf("[%2d] %c %3d %3d\n", 21, (char)_mm256_extract_epi8(v, 21), _mm256_extract_epi8(a, 21), _mm256_extract_epi8(b, 21));
-    printf("[%2d] %c %3d %3d\n", 22, (char)_mm256_extract_epi8(v, 22), _mm256_extract_epi8(a, 22), _mm256_extract_epi8(b, 22));
-    printf("[%2d] %c %3d %3d\n", 23, (char)_mm256_extract_epi8(v, 23), _mm256_extract_epi8(a, 23), _mm256_extract_epi8(b, 23));
-    printf("[%2d] %c %3d %3d\n", 24, (char)_mm256_extract_epi8(v, 24), _mm256_extract_epi8(a, 24), _mm256_extract_epi8(b, 24));
-    printf("[%2d] %c %3d %3d\n", 25, (char)_mm256_extract_epi8(v, 25), _mm256_extract_epi8(a, 25), _mm256_extract_epi8(b, 25));
-    printf("[%2d] %c %3d %3d\n", 26, (char)_mm256_extract_epi8(v, 26), _mm256_extract_epi8(a, 26), _mm256_extract_epi8(b, 26));
-    printf("[%2d] %c %3d %3d\n", 27, (char)_mm256_extract_epi8(v, 27), _mm256_extract_epi8(a, 27), _mm256_extract_epi8(b, 27));
-    printf("[%2d] %c %3d %3d\n", 28, (char)_mm256_extract_epi8(v, 28), _mm256_extract_epi8(a, 28), _mm256_extract_epi8(b, 28));
-    printf("[%2d] %c %3d %3d\n", 29, (char)_mm256_extract_epi8(v, 29), _mm256_extract_epi8(a, 29), _mm256_extract_epi8(b, 29));
-    printf("[%2d] %c %3d %3d\n", 30, (char)_mm256_extract_epi8(v, 30), _mm256_extract_epi8(a, 30), _mm256_extract_epi8(b, 30));
-    printf("[%2d] %c %3d %3d\n", 31, (char)_mm256_extract_epi8(v, 31), _mm256_extract_epi8(a, 31), _mm256_extract_epi8(b, 31));
-
-    exit(0);
-
-    if (argc == 1) {
-        process(STDIN_FILENO, "");
-    } else {
-        for (int i = 1; i < argc; ++i) {
-            run_file(argv[i]);
-        }
-    }
+	int opt, rc = 0;
+	long nthreads = 1;
+	wc_input_kind input = WC_INPUT_READ;
+	wc_result total = { 0, 0, 0, 0, 0 };
+
+	kernel = wc_kernel_best();
+	while ((opt = getopt(argc, argv, "i:j:k:m")) != -1) {
+		switch (opt) {
+		case 'i':
+			if (wc_input_parse(optarg, &input) != 0) {
+				fprintf(stderr, "error: unknown input backend: %s\n", optarg);
+				return 1;
+			}
+			break;
+		case 'k':
+			kernel = wc_kernel_find(optarg);
+			if (!kernel) {
+				fprintf(stderr, "error: kernel not available: %s\n", optarg);
+				return 1;
+			}
+			break;
+		case 'm':
+			count_utf8 = true;
+			break;
+		case 'j':
+			nthreads = strtol(optarg, NULL, 10);
+			if (nthreads <= 0)
+				nthreads = sysconf(_SC_NPROCESSORS_ONLN);
+			break;
+		default:
+			fprintf(stderr, "Usage: %s [-i read|bigread|mmap|uring] [-j THREADS] [-k avx512bw|avx2|sse42|scalar] [-m] [FILE]...\n", argv[0]);
+			return 1;
+		}
+	}
+
+	if (optind == argc) {
+		rc = process(STDIN_FILENO, "", input, &total);
+	} else if (nthreads > 1) {
+		rc = process_parallel(argv + optind, (size_t)(argc - optind), (int)nthreads, input);
+	} else {
+		for (int i = optind; i < argc; ++i) {
+			rc |= run_file(argv[i], input, &total);
+		}
+		if (argc - optind > 1)
+			print_counts(&total, "total");
+	}
 
-    return 0;
+	return rc;
 }
@@ -0,0 +1,116 @@
+#include "wc_classify.h"
+#include "wc_kernel.h"
+#include <string.h>
+
+void wc_classes_init(wc_classes *cls)
+{
+	memset(cls, 0, sizeof(*cls));
+	cls->ops = wc_kernel_best()->classify;
+}
+
+static int add_set(wc_classes *cls, const bool member[256])
+{
+	uint16_t lows[16] = { 0 }; /* low nibbles present, per high nibble */
+	bool done[16] = { false };
+	uint8_t lo[16], hi[16], mask = 0;
+	unsigned nbits = cls->nbits;
+
+	if (cls->nclasses == WC_CLASS_MAX)
+		return -1;
+	for (unsigned b = 0; b < 256; ++b) {
+		if (member[b])
+			lows[b >> 4] |= (uint16_t)(1u << (b & 0xf));
+	}
+	memcpy(lo, cls->lo, sizeof(lo));
+	memcpy(hi, cls->hi, sizeof(hi));
+	for (unsigned h = 0; h < 16; ++h) {
+		if (done[h] || lows[h] == 0)
+			continue;
+		if (nbits == 8)
+			return -1;
+		const uint8_t bit = (uint8_t)(1u << nbits++);
+		// every high nibble with the same low nibbles shares the bit
+		for (unsigned g = h; g < 16; ++g) {
+			if (lows[g] == lows[h]) {
+				hi[g] |= bit;
+				done[g] = true;
+			}
+		}
+		for (unsigned l = 0; l < 16; ++l) {
+			if (lows[h] & (1u << l))
+				lo[l] |= bit;
+		}
+		mask |= bit;
+	}
+	memcpy(cls->lo, lo, sizeof(lo));
+	memcpy(cls->hi, hi, sizeof(hi));
+	cls->nbits = nbits;
+	cls->mask[cls->nclasses] = mask;
+	return (int)cls->nclasses++;
+}
+
+int wc_classes_add(wc_classes *cls, const char *bytes, size_t n)
+{
+	bool member[256] = { false };
+
+	for (size_t i = 0; i < n; ++i)
+		member[(unsigned char)bytes[i]] = true;
+	return add_set(cls, member);
+}
+
+int wc_classes_add_range(wc_classes *cls, unsigned char first, unsigned char last)
+{
+	bool member[256] = { false };
+
+	for (unsigned b = first; b <= last; ++b)
+		member[b] = true;
+	return add_set(cls, member);
+}
+
+typedef wc_classes classify_tables;
+
+static inline void classify_init(classify_tables *t, const wc_classes *cls)
+{
+	*t = *cls;
+}
+
+static inline void classify_block(const classify_tables *t, unsigned nclasses, const char *p,
+                                  uint64_t *masks)
+{
+	const unsigned char *s = (const unsigned char *)p;
+
+	for (unsigned c = 0; c < nclasses; ++c)
+		masks[c] = 0;
+	for (unsigned i = 0; i < WC_CLASS_BLOCK; ++i) {
+		const uint8_t tag = t->lo[s[i] & 0xf] & t->hi[s[i] >> 4];
+		for (unsigned c = 0; c < nclasses; ++c)
+			masks[c] |= (uint64_t)((tag & t->mask[c]) != 0) << i;
+	}
+}
+
+#define WC_CLASSIFY wc_classify_scalar
+#include "wc_classify_impl.h"
+
+void wc_classify_count(const wc_classes *cls, const char *p, size_t len, uint64_t *counts)
+{
+	cls->ops->count(cls, p, len, counts);
+}
+
+void wc_classify_bitmaps(const wc_classes *cls, const char *p, size_t len, uint64_t **bitmaps)
+{
+	cls->ops->bitmaps(cls, p, len, bitmaps);
+}
+
+void wc_csv_init(wc_classes *cls, char delim)
+{
+	// in the order of CSV_DELIM, CSV_QUOTE, CSV_NEWLINE
+	wc_classes_init(cls);
+	wc_classes_add(cls, &delim, 1);
+	wc_classes_add(cls, "\"", 1);
+	wc_classes_add(cls, "\n", 1);
+}
+
+void wc_csv_count(const wc_classes *cls, const char *p, size_t len, wc_csv_counts *counts)
+{
+	cls->ops->csv(cls, p, len, counts);
+}
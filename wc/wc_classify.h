@@ -0,0 +1,97 @@
+#ifndef WC_CLASSIFY_H
+#define WC_CLASSIFY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Byte classification with the pshufb trick from simd_cmpws_i8, generalized
+ * to user-defined classes: a byte b gets the 8-bit tag
+ *
+ *     lo[b & 0xf] & hi[b >> 4]
+ *
+ * and is in class c if the tag shares a bit with mask[c]. Each class takes
+ * one bit per group of high nibbles that share the same set of low nibbles,
+ * so digits, '\n' or ',' cost one bit each and ASCII whitespace two; all
+ * classes together have to fit in 8 bits.
+ *
+ * Every 64-byte block becomes one uint64_t bitmap per class, bit i set when
+ * byte i is in the class; the counters below consume the bitmaps in the same
+ * translation unit that produces them, once per instruction set.
+ */
+#define WC_CLASS_MAX 8
+#define WC_CLASS_BLOCK 64
+
+typedef struct wc_classes wc_classes;
+
+/* see wc_csv_count */
+typedef struct {
+	uint64_t fields, records;
+	bool in_quote;
+} wc_csv_counts;
+
+#define WC_CSV_COUNTS_INITIAL { 0, 0, false }
+
+typedef struct {
+	void (*count)(const wc_classes *cls, const char *p, size_t len, uint64_t *counts);
+	void (*bitmaps)(const wc_classes *cls, const char *p, size_t len, uint64_t **bitmaps);
+	void (*csv)(const wc_classes *cls, const char *p, size_t len, wc_csv_counts *counts);
+} wc_classify_ops;
+
+struct wc_classes {
+	uint8_t lo[16], hi[16];
+	uint8_t mask[WC_CLASS_MAX];
+	unsigned nclasses;
+	unsigned nbits;
+	const wc_classify_ops *ops;
+};
+
+extern const wc_classify_ops wc_classify_scalar;
+extern const wc_classify_ops wc_classify_sse42;
+extern const wc_classify_ops wc_classify_avx2;
+extern const wc_classify_ops wc_classify_avx512bw;
+
+/* Starts an empty set of classes, classified with the fastest kernel. */
+void wc_classes_init(wc_classes *cls);
+
+/* Adds a class of the `n` bytes at `bytes`; returns its index, or -1 if
+ * there are already WC_CLASS_MAX classes or the tag bits ran out. */
+int wc_classes_add(wc_classes *cls, const char *bytes, size_t n);
+
+/* Adds the class of bytes `first` to `last` inclusive. */
+int wc_classes_add_range(wc_classes *cls, unsigned char first, unsigned char last);
+
+/*
+ * Adds the number of bytes of `p[0..len)` in each class to `counts[0..nclasses)`.
+ */
+void wc_classify_count(const wc_classes *cls, const char *p, size_t len, uint64_t *counts);
+
+/*
+ * Writes the positions of class `c` bytes in `p[0..len)` to `bitmaps[c]`, an
+ * array of (len + 63) / 64 words each; bits past `len` are zero.
+ */
+void wc_classify_bitmaps(const wc_classes *cls, const char *p, size_t len, uint64_t **bitmaps);
+
+/*
+ * CSV field and record counting on the delimiter bitmaps. Delimiters and
+ * line feeds between double quotes don't count; a quote toggles the quoted
+ * state, so "" escapes work out by themselves. A record is a line feed, so a
+ * last line without one isn't counted; fields are delimiters plus records.
+ * `in_quote` carries across calls, so a file can be fed in pieces.
+ *
+ * wc_csv_init() sets up `cls` with the three classes wc_csv_count() needs.
+ */
+void wc_csv_init(wc_classes *cls, char delim);
+
+void wc_csv_count(const wc_classes *cls, const char *p, size_t len, wc_csv_counts *counts);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
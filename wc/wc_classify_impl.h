@@ -0,0 +1,137 @@
+/*
+ * Consumers of the byte-class bitmaps, compiled once per instruction set so
+ * the popcounts and the block classifier end up in the same loop. The
+ * including file defines WC_CLASSIFY to the name of the wc_classify_ops it
+ * exports, and before including this a `classify_tables` type with
+ * `classify_init(tables, cls)` and `classify_block(tables, nclasses, p,
+ * masks)`, which turns the 64 bytes at p into bitmaps of the first nclasses
+ * classes.
+ */
+#ifndef WC_CLASSIFY
+#error "define WC_CLASSIFY before including wc_classify_impl.h"
+#endif
+
+#include <string.h>
+#include "wc_classify.h"
+
+/*
+ * Classifies `p[0..len)` block by block and calls `fn` with the bitmaps of
+ * the first `nclasses` classes; the last block is zero-padded and its
+ * bitmaps cleared past `len`. Always inlined so `fn` is too, the bitmaps can
+ * stay in registers, and a constant `nclasses` unrolls the class loops.
+ */
+typedef void (*classify_block_fn)(void *ctx, size_t block, const uint64_t *masks);
+
+static inline __attribute__((always_inline))
+void for_each_block(const wc_classes *cls, unsigned nclasses, const char *p, size_t len,
+                    classify_block_fn fn, void *ctx)
+{
+	uint64_t masks[WC_CLASS_MAX];
+	classify_tables tables;
+	const size_t nfull = len / WC_CLASS_BLOCK;
+	size_t b = 0;
+
+	classify_init(&tables, cls);
+	for (; b < nfull; ++b) {
+		classify_block(&tables, nclasses, p + b * WC_CLASS_BLOCK, masks);
+		fn(ctx, b, masks);
+	}
+	if (len % WC_CLASS_BLOCK) {
+		char tail[WC_CLASS_BLOCK] = { 0 };
+		const size_t rem = len % WC_CLASS_BLOCK;
+		memcpy(tail, p + b * WC_CLASS_BLOCK, rem);
+		classify_block(&tables, nclasses, tail, masks);
+		for (unsigned c = 0; c < nclasses; ++c)
+			masks[c] &= ((uint64_t)1 << rem) - 1;
+		fn(ctx, b, masks);
+	}
+}
+
+typedef struct {
+	unsigned nclasses;
+	uint64_t *counts;
+} count_ctx;
+
+static inline void count_block(void *arg, size_t block, const uint64_t *masks)
+{
+	count_ctx *ctx = arg;
+
+	(void)block;
+	for (unsigned c = 0; c < ctx->nclasses; ++c)
+		ctx->counts[c] += (uint64_t)__builtin_popcountll(masks[c]);
+}
+
+static void classify_count(const wc_classes *cls, const char *p, size_t len, uint64_t *counts)
+{
+	// counted locally so the totals can stay in registers
+	uint64_t local[WC_CLASS_MAX] = { 0 };
+	count_ctx ctx = { cls->nclasses, local };
+
+	for_each_block(cls, cls->nclasses, p, len, count_block, &ctx);
+	for (unsigned c = 0; c < cls->nclasses; ++c)
+		counts[c] += local[c];
+}
+
+typedef struct {
+	unsigned nclasses;
+	uint64_t **bitmaps;
+} bitmap_ctx;
+
+static inline void bitmap_block(void *arg, size_t block, const uint64_t *masks)
+{
+	bitmap_ctx *ctx = arg;
+
+	for (unsigned c = 0; c < ctx->nclasses; ++c)
+		ctx->bitmaps[c][block] = masks[c];
+}
+
+static void classify_bitmaps(const wc_classes *cls, const char *p, size_t len, uint64_t **bitmaps)
+{
+	bitmap_ctx ctx = { cls->nclasses, bitmaps };
+
+	for_each_block(cls, cls->nclasses, p, len, bitmap_block, &ctx);
+}
+
+/* bit i of the result is the xor of bits 0..i of x */
+static inline uint64_t prefix_xor(uint64_t x)
+{
+	x ^= x << 1;
+	x ^= x << 2;
+	x ^= x << 4;
+	x ^= x << 8;
+	x ^= x << 16;
+	x ^= x << 32;
+	return x;
+}
+
+/* class indices set up by wc_csv_init */
+enum { CSV_DELIM, CSV_QUOTE, CSV_NEWLINE };
+
+static inline void csv_block(void *arg, size_t block, const uint64_t *masks)
+{
+	wc_csv_counts *counts = arg;
+	// bytes between an opening quote and its closing quote
+	const uint64_t quoted = prefix_xor(masks[CSV_QUOTE]) ^ (counts->in_quote ? ~(uint64_t)0 : 0);
+	const uint64_t delims = masks[CSV_DELIM] & ~quoted;
+	const uint64_t lines  = masks[CSV_NEWLINE] & ~quoted;
+
+	(void)block;
+	counts->in_quote = quoted >> 63;
+	counts->records += (uint64_t)__builtin_popcountll(lines);
+	counts->fields  += (uint64_t)__builtin_popcountll(delims) +
+	                   (uint64_t)__builtin_popcountll(lines);
+}
+
+static void classify_csv(const wc_classes *cls, const char *p, size_t len, wc_csv_counts *counts)
+{
+	wc_csv_counts local = *counts;
+
+	for_each_block(cls, 3, p, len, csv_block, &local);
+	*counts = local;
+}
+
+const wc_classify_ops WC_CLASSIFY = {
+	classify_count,
+	classify_bitmaps,
+	classify_csv,
+};
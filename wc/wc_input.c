@@ -0,0 +1,322 @@
+#define _GNU_SOURCE
+#include "wc_input.h"
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SMALL_BUFSIZE  4096
+#define BIG_BUFSIZE    (1u << 20)
+#define URING_DEPTH    8
+#define URING_BLOCK    (512u << 10)
+
+static const char *const names[WC_INPUT_COUNT] = {
+	"read", "bigread", "mmap", "uring",
+};
+
+const char *wc_input_name(wc_input_kind kind)
+{
+	return (unsigned)kind < WC_INPUT_COUNT ? names[kind] : "?";
+}
+
+int wc_input_parse(const char *name, wc_input_kind *kind)
+{
+	for (int i = 0; i < WC_INPUT_COUNT; ++i) {
+		if (strcasecmp(name, names[i]) == 0) {
+			*kind = (wc_input_kind)i;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/* read() into `bufsize`, passing on whole vectors and carrying the rest */
+static int run_read(int fd, size_t bufsize, wc_input_fn fn, void *ctx)
+{
+	char *buf = aligned_alloc(WC_INPUT_ALIGN, bufsize);
+	size_t rem = 0;
+	ssize_t len;
+	int rc = 0;
+
+	if (!buf)
+		return -1;
+	for (;;) {
+		len = read(fd, buf + rem, bufsize - rem);
+		if (len < 0 && errno == EINTR)
+			continue;
+		if (len <= 0)
+			break;
+		rem += (size_t)len;
+		const size_t n = rem & ~(size_t)(WC_INPUT_ALIGN - 1);
+		if (n == 0)
+			continue;
+		if ((rc = fn(ctx, buf, n)) != 0)
+			goto out;
+		memmove(buf, buf + n, rem - n);
+		rem -= n;
+	}
+	if (len < 0)
+		rc = -1;
+	else if (rem)
+		rc = fn(ctx, buf, rem);
+out:
+	free(buf);
+	return rc;
+}
+
+static int run_mmap(int fd, size_t size, wc_input_fn fn, void *ctx)
+{
+	void *p;
+	int rc;
+
+	if (size == 0)
+		return 0;
+	p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED)
+		return -1;
+	/* hints only: huge pages need THP for file mappings to be enabled */
+	madvise(p, size, MADV_SEQUENTIAL);
+	madvise(p, size, MADV_HUGEPAGE);
+	rc = fn(ctx, p, size);
+	munmap(p, size);
+	return rc;
+}
+
+/*
+ * Minimal io_uring driver on the raw syscalls: URING_DEPTH block reads are
+ * kept in flight and handed to `fn` strictly in file order.
+ */
+struct uring {
+	int fd;
+	void *sq_ptr, *cq_ptr;
+	size_t sq_len, cq_len;
+	struct io_uring_sqe *sqes;
+	size_t sqes_len;
+	unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+	unsigned *cq_head, *cq_tail, *cq_mask;
+	struct io_uring_cqe *cqes;
+	unsigned to_submit;
+};
+
+static int uring_init(struct uring *r, unsigned entries)
+{
+	struct io_uring_params p;
+
+	memset(r, 0, sizeof(*r));
+	memset(&p, 0, sizeof(p));
+	r->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+	if (r->fd < 0)
+		return -1;
+	r->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+	r->cq_len = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		if (r->cq_len > r->sq_len)
+			r->sq_len = r->cq_len;
+		r->cq_len = r->sq_len;
+	}
+	r->sq_ptr = mmap(NULL, r->sq_len, PROT_READ | PROT_WRITE,
+	                 MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+	if (r->sq_ptr == MAP_FAILED)
+		goto fail_sq;
+	if (p.features & IORING_FEAT_SINGLE_MMAP) {
+		r->cq_ptr = r->sq_ptr;
+	} else {
+		r->cq_ptr = mmap(NULL, r->cq_len, PROT_READ | PROT_WRITE,
+		                 MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+		if (r->cq_ptr == MAP_FAILED)
+			goto fail_cq;
+	}
+	r->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+	r->sqes = mmap(NULL, r->sqes_len, PROT_READ | PROT_WRITE,
+	               MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+	if (r->sqes == MAP_FAILED)
+		goto fail_sqes;
+
+	r->sq_head  = (unsigned *)((char *)r->sq_ptr + p.sq_off.head);
+	r->sq_tail  = (unsigned *)((char *)r->sq_ptr + p.sq_off.tail);
+	r->sq_mask  = (unsigned *)((char *)r->sq_ptr + p.sq_off.ring_mask);
+	r->sq_array = (unsigned *)((char *)r->sq_ptr + p.sq_off.array);
+	r->cq_head  = (unsigned *)((char *)r->cq_ptr + p.cq_off.head);
+	r->cq_tail  = (unsigned *)((char *)r->cq_ptr + p.cq_off.tail);
+	r->cq_mask  = (unsigned *)((char *)r->cq_ptr + p.cq_off.ring_mask);
+	r->cqes     = (struct io_uring_cqe *)((char *)r->cq_ptr + p.cq_off.cqes);
+	return 0;
+
+fail_sqes:
+	if (r->cq_ptr != r->sq_ptr)
+		munmap(r->cq_ptr, r->cq_len);
+fail_cq:
+	munmap(r->sq_ptr, r->sq_len);
+fail_sq:
+	close(r->fd);
+	return -1;
+}
+
+static void uring_exit(struct uring *r)
+{
+	munmap(r->sqes, r->sqes_len);
+	if (r->cq_ptr != r->sq_ptr)
+		munmap(r->cq_ptr, r->cq_len);
+	munmap(r->sq_ptr, r->sq_len);
+	close(r->fd);
+}
+
+static void uring_prep_read(struct uring *r, int fd, void *buf, unsigned len,
+                            uint64_t off, uint64_t user_data)
+{
+	const unsigned tail = *r->sq_tail;
+	const unsigned idx  = tail & *r->sq_mask;
+	struct io_uring_sqe *sqe = &r->sqes[idx];
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode    = IORING_OP_READ;
+	sqe->fd        = fd;
+	sqe->addr      = (uint64_t)(uintptr_t)buf;
+	sqe->len       = len;
+	sqe->off       = off;
+	sqe->user_data = user_data;
+	r->sq_array[idx] = idx;
+	__atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	r->to_submit++;
+}
+
+/* submits queued reads and waits for at least `wait` completions */
+static int uring_enter(struct uring *r, unsigned wait)
+{
+	for (;;) {
+		long n = syscall(__NR_io_uring_enter, r->fd, r->to_submit, wait,
+		                 wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+		if (n >= 0) {
+			r->to_submit -= (unsigned)n;
+			return 0;
+		}
+		if (errno != EINTR)
+			return -1;
+	}
+}
+
+static int run_uring(int fd, size_t size, wc_input_fn fn, void *ctx)
+{
+	struct uring r;
+	char *bufs;
+	int res[URING_DEPTH];
+	bool done[URING_DEPTH];
+	const size_t nblocks = (size + URING_BLOCK - 1) / URING_BLOCK;
+	size_t submitted = 0, consumed = 0;
+	int rc = 0;
+
+	if (uring_init(&r, URING_DEPTH) != 0)
+		return run_read(fd, BIG_BUFSIZE, fn, ctx);
+	bufs = aligned_alloc(4096, (size_t)URING_DEPTH * URING_BLOCK);
+	if (!bufs) {
+		uring_exit(&r);
+		return -1;
+	}
+
+#define BLOCK_LEN(b) \
+	((b) + 1 < nblocks ? URING_BLOCK : (unsigned)(size - (b) * URING_BLOCK))
+	for (; submitted < nblocks && submitted < URING_DEPTH; ++submitted) {
+		done[submitted] = false;
+		uring_prep_read(&r, fd, bufs + submitted * URING_BLOCK, BLOCK_LEN(submitted),
+		                submitted * URING_BLOCK, submitted);
+	}
+
+	while (consumed < nblocks) {
+		const size_t slot = consumed % URING_DEPTH;
+		char *buf = bufs + slot * URING_BLOCK;
+		const unsigned want = BLOCK_LEN(consumed);
+		size_t have;
+
+		while (!done[slot]) {
+			if (uring_enter(&r, 1) != 0) {
+				rc = -1;
+				goto out;
+			}
+			unsigned head = *r.cq_head;
+			const unsigned tail = __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE);
+			for (; head != tail; ++head) {
+				const struct io_uring_cqe *cqe = &r.cqes[head & *r.cq_mask];
+				const size_t s = (size_t)cqe->user_data % URING_DEPTH;
+				res[s]  = cqe->res;
+				done[s] = true;
+			}
+			__atomic_store_n(r.cq_head, head, __ATOMIC_RELEASE);
+		}
+		if (res[slot] < 0) {
+			errno = -res[slot];
+			rc = -1;
+			goto out;
+		}
+		/* short reads are rare on regular files; finish them synchronously */
+		for (have = (size_t)res[slot]; have < want; ) {
+			ssize_t n = pread(fd, buf + have, want - have,
+			                  (off_t)(consumed * URING_BLOCK + have));
+			if (n < 0 && errno == EINTR)
+				continue;
+			if (n <= 0) {
+				rc = -1;
+				goto out;
+			}
+			have += (size_t)n;
+		}
+		if ((rc = fn(ctx, buf, have)) != 0)
+			goto out;
+		++consumed;
+
+		if (submitted < nblocks) {
+			done[slot] = false;
+			uring_prep_read(&r, fd, buf, BLOCK_LEN(submitted),
+			                submitted * URING_BLOCK, submitted);
+			++submitted;
+		}
+	}
+#undef BLOCK_LEN
+
+out:
+	/* don't free buffers the kernel may still be writing into */
+	while (rc != 0 && submitted > consumed) {
+		const size_t slot = consumed % URING_DEPTH;
+		if (!done[slot] && uring_enter(&r, 1) != 0)
+			break;
+		unsigned head = *r.cq_head;
+		const unsigned tail = __atomic_load_n(r.cq_tail, __ATOMIC_ACQUIRE);
+		for (; head != tail; ++head)
+			done[(size_t)r.cqes[head & *r.cq_mask].user_data % URING_DEPTH] = true;
+		__atomic_store_n(r.cq_head, head, __ATOMIC_RELEASE);
+		while (submitted > consumed && done[consumed % URING_DEPTH])
+			++consumed;
+	}
+	free(bufs);
+	uring_exit(&r);
+	return rc;
+}
+
+int wc_input_run(wc_input_kind kind, int fd, wc_input_fn fn, void *ctx)
+{
+	struct stat st;
+	const bool regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+
+	switch (kind) {
+	case WC_INPUT_READ:
+		return run_read(fd, SMALL_BUFSIZE, fn, ctx);
+	case WC_INPUT_MMAP:
+		if (regular)
+			return run_mmap(fd, (size_t)st.st_size, fn, ctx);
+		break;
+	case WC_INPUT_URING:
+		if (regular)
+			return run_uring(fd, (size_t)st.st_size, fn, ctx);
+		break;
+	default:
+		break;
+	}
+	return run_read(fd, BIG_BUFSIZE, fn, ctx);
+}
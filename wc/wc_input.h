@@ -0,0 +1,41 @@
+#ifndef WC_INPUT_H
+#define WC_INPUT_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Input backends for the word counters. Each one reads `fd` to EOF and hands
+ * the data to `fn` in file order. Every call but the last gets a length that
+ * is a multiple of WC_INPUT_ALIGN, so the consumer only has to pad the tail.
+ * A non-zero return from `fn` stops the run and is returned.
+ */
+#define WC_INPUT_ALIGN 32
+
+typedef int (*wc_input_fn)(void *ctx, const char *buf, size_t len);
+
+typedef enum {
+	WC_INPUT_READ,    /* read() into a 4 KiB buffer, the original path */
+	WC_INPUT_BIGREAD, /* read() into a 1 MiB buffer */
+	WC_INPUT_MMAP,    /* mmap with MADV_SEQUENTIAL | MADV_HUGEPAGE */
+	WC_INPUT_URING,   /* io_uring with several reads in flight */
+	WC_INPUT_COUNT
+} wc_input_kind;
+
+/* Returns 0 on success, -1 (with errno set) on I/O errors. mmap and io_uring
+ * fall back to WC_INPUT_BIGREAD for non-regular files. */
+int wc_input_run(wc_input_kind kind, int fd, wc_input_fn fn, void *ctx);
+
+const char *wc_input_name(wc_input_kind kind);
+
+/* Returns -1 if `name` isn't a backend. */
+int wc_input_parse(const char *name, wc_input_kind *kind);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
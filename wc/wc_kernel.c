@@ -0,0 +1,191 @@
+#include "wc_kernel.h"
+#include <cpuid.h>
+#include <string.h>
+
+void wc_count_scalar(const char *p, size_t len, wc_counts *counts)
+{
+	bool prev_ws = counts->prev_ws;
+	for (size_t i = 0; i < len; ++i) {
+		const bool ws = wc_isspace(p[i]);
+		counts->lines += p[i] == '\n';
+		counts->words += prev_ws && !ws;
+		prev_ws = ws;
+	}
+	counts->prev_ws = prev_ws;
+}
+
+/*
+ * Word boundaries are decided per byte, the same way the vector kernels do:
+ * every byte of a space character is whitespace, and a word starts at a byte
+ * that is neither whitespace nor a continuation byte and follows whitespace.
+ * For valid UTF-8 that's exactly "a non-space character after a space".
+ */
+size_t wc_count_utf8_until(const char *p, size_t len, size_t stop, wc_counts *counts)
+{
+	const unsigned char *s = (const unsigned char *)p;
+	bool prev_ws = counts->prev_ws;
+	size_t i = 0;
+
+	if (counts->npending) {
+		// classify the space candidate cut off at the end of the last buffer
+		unsigned char seq[3];
+		size_t n = counts->npending;
+		memcpy(seq, counts->pending, n);
+		for (size_t k = 0; n < 3 && k < len; ++k)
+			seq[n++] = s[k];
+		const int r = wc_utf8_isspace(seq, n);
+		if (r < 0) {
+			for (; i < len; ++i) {
+				counts->utf8_state = wc_utf8_step(counts->utf8_state, s[i], &counts->invalid);
+				counts->pending[counts->npending++] = s[i];
+			}
+			return len;
+		}
+		if (r == 1) {
+			// the rest of the space is at the front of this buffer
+			for (; i < 3u - counts->npending; ++i)
+				counts->utf8_state = wc_utf8_step(counts->utf8_state, s[i], &counts->invalid);
+			prev_ws = true;
+		} else {
+			counts->words += prev_ws;
+			prev_ws = false;
+		}
+		counts->npending = 0;
+	}
+
+	for (; i < len; ++i) {
+		const unsigned char b = s[i];
+		if (i >= stop && !wc_utf8_cont(b))
+			break;
+		counts->utf8_state = wc_utf8_step(counts->utf8_state, b, &counts->invalid);
+		if (wc_utf8_cont(b)) {
+			prev_ws = false;
+			continue;
+		}
+		counts->chars++;
+		if (b < 0x80) {
+			const bool ws = wc_isspace((char)b);
+			counts->lines += b == '\n';
+			counts->words += prev_ws && !ws;
+			prev_ws = ws;
+			continue;
+		}
+		const int r = wc_utf8_isspace(s + i, len - i);
+		if (r < 0) {
+			// decide the word boundary once the rest of it arrives
+			counts->pending[counts->npending++] = b;
+			for (++i; i < len; ++i) {
+				counts->utf8_state = wc_utf8_step(counts->utf8_state, s[i], &counts->invalid);
+				counts->pending[counts->npending++] = s[i];
+			}
+			counts->prev_ws = prev_ws;
+			return len;
+		}
+		if (r == 1) {
+			for (size_t k = 1; k < 3; ++k)
+				counts->utf8_state = wc_utf8_step(counts->utf8_state, s[i + k], &counts->invalid);
+			i += 2;
+			prev_ws = true;
+		} else {
+			counts->words += prev_ws;
+			prev_ws = false;
+		}
+	}
+	counts->prev_ws = prev_ws;
+	return i;
+}
+
+void wc_count_utf8_scalar(const char *p, size_t len, wc_counts *counts)
+{
+	wc_count_utf8_until(p, len, len, counts);
+}
+
+void wc_count_utf8_finish(wc_counts *counts)
+{
+	if (counts->npending) {
+		// a truncated sequence at EOF: a non-space character
+		counts->words += counts->prev_ws;
+		counts->prev_ws = false;
+		counts->npending = 0;
+	}
+	if (counts->utf8_state != WC_UTF8_ACCEPT) {
+		counts->invalid++;
+		counts->utf8_state = WC_UTF8_ACCEPT;
+	}
+}
+
+enum {
+	ISA_NONE     = 0,
+	ISA_SSE42    = 1 << 0,
+	ISA_AVX2     = 1 << 1,
+	ISA_AVX512BW = 1 << 2,
+};
+
+const wc_kernel wc_kernels[] = {
+	{ "avx512bw", wc_count_avx512bw, wc_count_utf8_avx512bw, &wc_classify_avx512bw },
+	{ "avx2",     wc_count_avx2,     wc_count_utf8_avx2,     &wc_classify_avx2     },
+	{ "sse42",    wc_count_sse42,    wc_count_utf8_sse42,    &wc_classify_sse42    },
+	{ "scalar",   wc_count_scalar,   wc_count_utf8_scalar,   &wc_classify_scalar   },
+};
+const size_t wc_nkernels = sizeof(wc_kernels)/sizeof(wc_kernels[0]);
+
+static const unsigned kernel_isa[] = {
+	ISA_AVX512BW, ISA_AVX2, ISA_SSE42, ISA_NONE,
+};
+
+static uint64_t xgetbv0(void)
+{
+	uint32_t eax, edx;
+	__asm__ volatile ("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+	return ((uint64_t)edx << 32) | eax;
+}
+
+/* Instruction sets both the CPU and the OS (saved register state) support. */
+static unsigned detect_isa(void)
+{
+	unsigned eax, ebx, ecx, edx, isa = ISA_NONE;
+	uint64_t xcr0 = 0;
+
+	if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		return isa;
+	if ((ecx & bit_SSE4_2) && (ecx & bit_POPCNT) && (ecx & bit_SSSE3))
+		isa |= ISA_SSE42;
+	if (ecx & bit_OSXSAVE)
+		xcr0 = xgetbv0();
+	if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+		return isa;
+	// XMM|YMM state for AVX2, plus opmask and ZMM state for AVX-512
+	if ((isa & ISA_SSE42) && (ebx & bit_AVX2) && (xcr0 & 0x06) == 0x06)
+		isa |= ISA_AVX2;
+	if ((isa & ISA_AVX2) && (ebx & bit_AVX512F) && (ebx & bit_AVX512BW) &&
+	    (xcr0 & 0xE6) == 0xE6)
+		isa |= ISA_AVX512BW;
+	return isa;
+}
+
+bool wc_kernel_supported(const wc_kernel *kernel)
+{
+	static unsigned isa = ~0u;
+	if (isa == ~0u)
+		isa = detect_isa();
+	const size_t i = (size_t)(kernel - wc_kernels);
+	return i < wc_nkernels && (kernel_isa[i] & ~isa) == 0;
+}
+
+const wc_kernel *wc_kernel_best(void)
+{
+	for (size_t i = 0; i < wc_nkernels; ++i) {
+		if (wc_kernel_supported(&wc_kernels[i]))
+			return &wc_kernels[i];
+	}
+	return &wc_kernels[wc_nkernels - 1];
+}
+
+const wc_kernel *wc_kernel_find(const char *name)
+{
+	for (size_t i = 0; i < wc_nkernels; ++i) {
+		if (strcmp(wc_kernels[i].name, name) == 0)
+			return wc_kernel_supported(&wc_kernels[i]) ? &wc_kernels[i] : NULL;
+	}
+	return NULL;
+}
@@ -0,0 +1,175 @@
+#ifndef WC_KERNEL_H
+#define WC_KERNEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "wc_classify.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Line/word counting kernels, one per instruction set, all built into the
+ * same binary and picked at startup with cpuid.
+ *
+ * A kernel adds the line feeds and word starts in `p[0..len)` to `counts`.
+ * `prev_ws` carries whether the byte before `p` was whitespace, so a stream
+ * can be fed in pieces of any size.
+ */
+typedef struct {
+	uint64_t lines, words;
+	bool prev_ws;
+
+	/* UTF-8 kernels only */
+	uint64_t chars;      /* non-continuation bytes */
+	uint64_t invalid;    /* malformed sequences */
+	uint8_t  utf8_state; /* validator state, WC_UTF8_ACCEPT between characters */
+	uint8_t  npending;   /* bytes of a possible multi-byte space cut off by the */
+	uint8_t  pending[3]; /* end of the last buffer, not yet classified */
+} wc_counts;
+
+#define WC_COUNTS_INITIAL { 0, 0, true, 0, 0, 0, 0, { 0, 0, 0 } }
+
+typedef void (*wc_count_fn)(const char *p, size_t len, wc_counts *counts);
+
+/*
+ * `count` treats the input as ASCII. `count_utf8` also counts characters,
+ * validates, and treats the Unicode spaces (U+1680, U+2000-U+2006,
+ * U+2008-U+200A, U+2028, U+2029, U+205F, U+3000, as glibc's iswspace) as word
+ * separators; call wc_count_utf8_finish() after the last buffer.
+ */
+typedef struct {
+	const char *name;
+	wc_count_fn count;
+	wc_count_fn count_utf8;
+	const wc_classify_ops *classify;
+} wc_kernel;
+
+void wc_count_scalar(const char *p, size_t len, wc_counts *counts);
+void wc_count_sse42(const char *p, size_t len, wc_counts *counts);
+void wc_count_avx2(const char *p, size_t len, wc_counts *counts);
+void wc_count_avx512bw(const char *p, size_t len, wc_counts *counts);
+
+void wc_count_utf8_scalar(const char *p, size_t len, wc_counts *counts);
+void wc_count_utf8_sse42(const char *p, size_t len, wc_counts *counts);
+void wc_count_utf8_avx2(const char *p, size_t len, wc_counts *counts);
+void wc_count_utf8_avx512bw(const char *p, size_t len, wc_counts *counts);
+void wc_count_utf8_finish(wc_counts *counts);
+
+/* Scalar UTF-8 counting of `p[0..len)` that stops at the first character
+ * boundary at or after `stop`; returns the number of bytes consumed. */
+size_t wc_count_utf8_until(const char *p, size_t len, size_t stop, wc_counts *counts);
+
+/* all kernels, fastest first */
+extern const wc_kernel wc_kernels[];
+extern const size_t wc_nkernels;
+
+bool wc_kernel_supported(const wc_kernel *kernel);
+
+/* The fastest kernel this CPU supports. */
+const wc_kernel *wc_kernel_best(void);
+
+/* The kernel called `name`, or NULL if unknown or unsupported on this CPU. */
+const wc_kernel *wc_kernel_find(const char *name);
+
+static inline bool wc_isspace(char c)
+{
+	return c == ' ' || ('\t' <= c && c <= '\r');
+}
+
+#define WC_UTF8_ACCEPT 0
+
+static inline bool wc_utf8_cont(unsigned char b)
+{
+	return (b & 0xC0) == 0x80;
+}
+
+/* One step of the UTF-8 validator: returns the next state, counting an error
+ * in `*invalid` (and restarting on `b`) when `b` can't continue the sequence. */
+static inline uint8_t wc_utf8_step(uint8_t state, unsigned char b, uint64_t *invalid)
+{
+	enum { NEED1 = 1, NEED2, NEED3, AFTER_E0, AFTER_ED, AFTER_F0, AFTER_F4 };
+	switch (state) {
+	case WC_UTF8_ACCEPT:
+		break;
+	case NEED1: case NEED2: case NEED3:
+		if (wc_utf8_cont(b))
+			return (uint8_t)(state - 1);
+		goto error;
+	case AFTER_E0:
+		if (0xA0 <= b && b <= 0xBF)
+			return NEED1;
+		goto error;
+	case AFTER_ED:
+		if (0x80 <= b && b <= 0x9F)
+			return NEED1;
+		goto error;
+	case AFTER_F0:
+		if (0x90 <= b && b <= 0xBF)
+			return NEED2;
+		goto error;
+	case AFTER_F4:
+		if (0x80 <= b && b <= 0x8F)
+			return NEED2;
+		goto error;
+	}
+	goto start;
+error:
+	++*invalid;
+start:
+	if (b < 0x80)
+		return WC_UTF8_ACCEPT;
+	if (0xC2 <= b && b <= 0xDF)
+		return NEED1;
+	if (b == 0xE0)
+		return AFTER_E0;
+	if (b == 0xED)
+		return AFTER_ED;
+	if (0xE1 <= b && b <= 0xEF)
+		return NEED2;
+	if (b == 0xF0)
+		return AFTER_F0;
+	if (0xF1 <= b && b <= 0xF3)
+		return NEED3;
+	if (b == 0xF4)
+		return AFTER_F4;
+	++*invalid;
+	return WC_UTF8_ACCEPT;
+}
+
+/* Whether `s[0..n)`, starting at a lead byte, is a multi-byte Unicode space:
+ * 1 if it is (always 3 bytes long), 0 if not, -1 if `n` is too short to tell. */
+static inline int wc_utf8_isspace(const unsigned char *s, size_t n)
+{
+	if (s[0] < 0xE1 || s[0] > 0xE3)
+		return 0;
+	if (n < 2)
+		return -1;
+	switch (s[0]) {
+	case 0xE1:
+		if (s[1] != 0x9A)
+			return 0;
+		return n < 3 ? -1 : s[2] == 0x80;
+	case 0xE2:
+		if (s[1] != 0x80 && s[1] != 0x81)
+			return 0;
+		if (n < 3)
+			return -1;
+		if (s[1] == 0x81)
+			return s[2] == 0x9F;
+		return (s[2] >= 0x80 && s[2] <= 0x8A && s[2] != 0x87) ||
+		       s[2] == 0xA8 || s[2] == 0xA9;
+	default:
+		if (s[1] != 0x80)
+			return 0;
+		return n < 3 ? -1 : s[2] == 0x80;
+	}
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
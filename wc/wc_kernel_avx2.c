@@ -0,0 +1,4 @@
+#define WC_KERNEL      wc_count_avx2
+#define WC_KERNEL_UTF8 wc_count_utf8_avx2
+#define WC_CLASSIFY    wc_classify_avx2
+#include "wc_kernel_impl.h"
@@ -0,0 +1,4 @@
+#define WC_KERNEL      wc_count_avx512bw
+#define WC_KERNEL_UTF8 wc_count_utf8_avx512bw
+#define WC_CLASSIFY    wc_classify_avx512bw
+#include "wc_kernel_impl.h"
@@ -0,0 +1,417 @@
+/*
+ * Body of the vectorized wc kernels, written against my_simd.h. Included once
+ * per instruction set by wc_kernel_<isa>.c, which defines WC_KERNEL,
+ * WC_KERNEL_UTF8 and WC_CLASSIFY to the function names and is compiled with
+ * the matching -m flags.
+ */
+#if !defined(WC_KERNEL) || !defined(WC_KERNEL_UTF8) || !defined(WC_CLASSIFY)
+#error "define WC_KERNEL, WC_KERNEL_UTF8 and WC_CLASSIFY before including wc_kernel_impl.h"
+#endif
+
+#include <string.h>
+#include "wc_kernel.h"
+#include "my_simd.h"
+
+#ifndef SIMD_KMASK
+
+/*
+ * Byte-wise vector accumulators: every line feed / word start subtracts -1
+ * from its lane, and the lanes are summed with SAD before they can overflow.
+ */
+typedef struct {
+	simd_vector vcount, count;
+	uint8_t iterations;
+} lcount_state;
+typedef struct {
+	simd_vector vcount, count, prev_eqws;
+	uint8_t iterations;
+} wcount_state;
+#define LCOUNT_INITIAL \
+	(lcount_state){ simd_setzero(), simd_setzero(), 0 }
+#define WCOUNT_INITIAL \
+	(wcount_state){ simd_setzero(), simd_setzero(), simd_set_i8(-1), 0 }
+
+static inline void wcount_state_set(wcount_state *state, bool wcontinue)
+{
+	state->prev_eqws = wcontinue ? simd_setzero() : simd_set_i8(-1);
+}
+
+static inline uint64_t simd_hsum_u64(simd_vector v)
+{
+	union {
+		simd_vector vec;
+		uint64_t u64[SIMD_WIDTH/sizeof(uint64_t)];
+	} unpack;
+	uint64_t sum = 0;
+	simd_store(&unpack.vec, v);
+	for (size_t i = 0; i != SIMD_WIDTH/sizeof(uint64_t); ++i)
+		sum += unpack.u64[i];
+	return sum;
+}
+
+static inline uint64_t count_lines_final(lcount_state *state)
+{
+	state->count = simd_add_i64(state->count,
+	                            simd_sad_u8(state->vcount, simd_setzero()));
+	state->vcount = simd_setzero();
+	return simd_hsum_u64(state->count);
+}
+
+static inline uint64_t count_words_final(wcount_state *state)
+{
+	state->count = simd_add_i64(state->count,
+	                            simd_sad_u8(state->vcount, simd_setzero()));
+	state->vcount = simd_setzero();
+	return simd_hsum_u64(state->count);
+}
+
+static inline int count_lines(simd_vector vec, lcount_state *state)
+{
+	simd_vector is_line_feed = simd_cmpeq_i8(vec, simd_set_i8('\n'));
+	// is_line_feed has a value of -1 for line feeds, 0 otherwise
+	state->vcount = simd_sub_i8(state->vcount, is_line_feed);
+	state->iterations++;
+	if (state->iterations == 255) {
+		// sum line feed position counts before they can overflow
+		state->count = simd_add_i64(state->count,
+		                            simd_sad_u8(state->vcount, simd_setzero()));
+		state->vcount = simd_setzero();
+		state->iterations = 0;
+	}
+	return 0;
+}
+
+static inline int count_words_wsmask(simd_mask eqmask, wcount_state *state)
+{
+	simd_vector eqws = simd_vector_from_mask(eqmask),
+	            andmsk = simd_shl1_from_i8(eqws, state->prev_eqws),
+	            is_first_char = simd_andnot_i8(eqws, andmsk);
+	state->prev_eqws = eqws;
+	// is_first_char has a value of -1 for word starting characters, 0 otherwise
+	state->vcount = simd_sub_i8(state->vcount, is_first_char);
+	state->iterations++;
+	if (state->iterations == 255) {
+		// sum first character position counts before they can overflow
+		state->count = simd_add_i64(state->count,
+		                            simd_sad_u8(state->vcount, simd_setzero()));
+		state->vcount = simd_setzero();
+		state->iterations = 0;
+	}
+	return 0;
+}
+
+static inline int count_words(simd_vector vec, wcount_state *state)
+{
+	return count_words_wsmask(simd_cmpws_i8_mask(vec), state);
+}
+
+#endif /* !SIMD_KMASK */
+
+void WC_KERNEL(const char *p, size_t len, wc_counts *counts)
+{
+	size_t i = 0;
+
+#ifdef SIMD_KMASK
+	// k-mask registers: word starts are non-space bytes whose predecessor is
+	// space, found with one shift of the whitespace mask and a popcount
+	uint64_t lines = 0, words = 0;
+	simd_imask prev = counts->prev_ws ? 1 : 0;
+	for (; i + SIMD_WIDTH <= len; i += SIMD_WIDTH) {
+		const simd_vector v  = simd_loadu(p + i);
+		const simd_imask  ws = simd_imask_from_mask(simd_cmpws_i8_mask(v));
+		const simd_imask  lf = simd_imask_from_mask(simd_cmpeq_i8_mask(v, simd_set_i8('\n')));
+		words += simd_imask_popcnt(~ws & ((ws << 1) | prev));
+		lines += simd_imask_popcnt(lf);
+		prev = ws >> (SIMD_WIDTH - 1);
+	}
+	counts->lines += lines;
+	counts->words += words;
+#else
+	if (len >= SIMD_WIDTH) {
+		lcount_state lstate = LCOUNT_INITIAL;
+		wcount_state wstate = WCOUNT_INITIAL;
+		wcount_state_set(&wstate, !counts->prev_ws);
+		for (; i + SIMD_WIDTH <= len; i += SIMD_WIDTH) {
+			const simd_vector v = simd_loadu(p + i);
+			count_lines(v, &lstate);
+			count_words(v, &wstate);
+		}
+		counts->lines += count_lines_final(&lstate);
+		counts->words += count_words_final(&wstate);
+	}
+#endif
+
+	if (i > 0)
+		counts->prev_ws = wc_isspace(p[i - 1]);
+	wc_count_scalar(p + i, len - i, counts);
+}
+
+/*
+ * Vector UTF-8 validation, the lookup method of Keiser and Lemire ("Validating
+ * UTF-8 In Less Than One Instruction Per Byte"). Every error shows in a byte
+ * and the one to three bytes before it, so a block is checked against itself
+ * shifted by one, two and three bytes, with the end of the block before
+ * shifted in. Nibble lookups of the byte before (high and low) and of the byte
+ * itself give the error classes each pair could be in, and their AND is the
+ * classes it is in; a byte after a 3 or 4 byte lead must be a continuation,
+ * which is the only class where being one is right, hence the XOR.
+ */
+enum {
+	UTF8_TOO_SHORT      = 1 << 0, /* lead then no continuation */
+	UTF8_TOO_LONG       = 1 << 1, /* ASCII then continuation */
+	UTF8_OVERLONG_3     = 1 << 2, /* E0 80..9F */
+	UTF8_TOO_LARGE      = 1 << 3, /* F4 90..BF, F5..FF */
+	UTF8_SURROGATE      = 1 << 4, /* ED A0..BF */
+	UTF8_OVERLONG_2     = 1 << 5, /* C0, C1 */
+	UTF8_TOO_LARGE_1000 = 1 << 6, /* F5..FF 80..8F */
+	UTF8_OVERLONG_4     = 1 << 6, /* F0 80..8F */
+	UTF8_TWO_CONTS      = 1 << 7, /* continuation then continuation */
+	UTF8_CARRY          = UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS,
+};
+
+static const uint8_t utf8_byte1_high[16] = {
+	/* 0_______ */
+	UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+	UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+	/* 10______ */
+	UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+	/* 1100____ */
+	UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+	/* 1101____ */
+	UTF8_TOO_SHORT,
+	/* 1110____ */
+	UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+	/* 1111____ */
+	UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+};
+
+static const uint8_t utf8_byte1_low[16] = {
+	/* ____0000 */
+	UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+	/* ____0001 */
+	UTF8_CARRY | UTF8_OVERLONG_2,
+	/* ____001_ */
+	UTF8_CARRY,
+	UTF8_CARRY,
+	/* ____0100 */
+	UTF8_CARRY | UTF8_TOO_LARGE,
+	/* ____0101 .. ____1100 */
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	/* ____1101 */
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+	/* ____111_ */
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+	UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+};
+
+static const uint8_t utf8_byte2_high[16] = {
+	/* 0_______ */
+	UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+	UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+	/* 1000____ */
+	UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 |
+		UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+	/* 1001____ */
+	UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+	/* 101_____ */
+	UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+	UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+	/* 11______ */
+	UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+};
+
+typedef struct {
+	simd_vector byte1_high, byte1_low, byte2_high;
+} utf8_tables;
+
+static inline void utf8_tables_init(utf8_tables *t)
+{
+	t->byte1_high = simd_broadcast16(utf8_byte1_high);
+	t->byte1_low  = simd_broadcast16(utf8_byte1_low);
+	t->byte2_high = simd_broadcast16(utf8_byte2_high);
+}
+
+/* nonzero bytes where `v`, following `prev`, isn't valid UTF-8 */
+static inline __attribute__((always_inline))
+simd_vector utf8_check_block(const utf8_tables *t, simd_vector v, simd_vector prev)
+{
+	const simd_vector low4  = simd_set_i8(0x0f);
+	const simd_vector prev1 = simd_shln_from_i8(v, prev, 1);
+	const simd_vector prev2 = simd_shln_from_i8(v, prev, 2);
+	const simd_vector prev3 = simd_shln_from_i8(v, prev, 3);
+	const simd_vector sc = simd_and(
+		simd_and(simd_shuffle_i8(t->byte1_high, simd_and(simd_srli_i16(prev1, 4), low4)),
+		         simd_shuffle_i8(t->byte1_low, simd_and(prev1, low4))),
+		simd_shuffle_i8(t->byte2_high, simd_and(simd_srli_i16(v, 4), low4)));
+	// the top bit is set two bytes after E0..FF and three after F0..FF
+	const simd_vector must23 = simd_or(simd_subs_u8(prev2, simd_set_i8((char)(0xE0 - 0x80))),
+	                                   simd_subs_u8(prev3, simd_set_i8((char)(0xF0 - 0x80))));
+	return simd_xor(simd_and(must23, simd_set_i8((char)0x80)), sc);
+}
+
+/*
+ * The validator state after a block that passed utf8_check_block, ending at
+ * `end`: replayed from the last byte that isn't a continuation, at most 4
+ * back. The check only sees a lead byte that is never valid (C0, C1, F5..FF)
+ * from the byte after it, so one at the very end is counted here instead.
+ */
+static inline uint8_t utf8_tail_state(const unsigned char *end, uint64_t *invalid)
+{
+	uint8_t state = WC_UTF8_ACCEPT;
+	int k = 1;
+	while (k < 4 && wc_utf8_cont(end[-k]))
+		++k;
+	for (; k > 0; --k)
+		state = wc_utf8_step(state, end[-k], invalid);
+	return state;
+}
+
+/*
+ * UTF-8: characters are the bytes that aren't continuation bytes (10xxxxxx),
+ * and continuation bytes never start a word (see wc_count_utf8_until).
+ *
+ * Blocks are validated with utf8_check_block, skipped for ASCII blocks after
+ * ASCII blocks. Only a block the check fails is run through the scalar
+ * validator, from the exact state, to count its malformed sequences; as
+ * errors can reach 3 bytes into the next block, the block after one with an
+ * error in its last 4 bytes is too. The validator state is otherwise left
+ * implied by the bytes, and only worked out when needed.
+ *
+ * Unicode spaces are all 3 bytes, E1, E2 or E3 and two more, so in blocks
+ * with one of those leads the block is also compared at offsets 1 and 2 and
+ * the spaces matched as masks; a space's bytes are all whitespace, the ones
+ * past the end of the block spilling into the next.
+ */
+void WC_KERNEL_UTF8(const char *p, size_t len, wc_counts *counts)
+{
+	const uint64_t all = SIMD_WIDTH == 64 ? ~(uint64_t)0 : ((uint64_t)1 << SIMD_WIDTH) - 1;
+	const unsigned char *s = (const unsigned char *)p;
+	uint64_t lines = 0, words = 0, chars = 0, spill = 0, prev, prev_high = 0;
+	simd_vector prev_block = simd_setzero();
+	utf8_tables tables;
+	uint8_t state;
+	bool synced, implied = false;
+	// finish a character, or a space, left over from the last buffer
+	size_t i = wc_count_utf8_until(p, len, 0, counts);
+
+	utf8_tables_init(&tables);
+	prev  = counts->prev_ws;
+	state = counts->utf8_state;
+	// with nothing before the first block, the check takes it to follow ASCII
+	synced = state == WC_UTF8_ACCEPT;
+	// keep two bytes of lookahead so every multi-byte space that starts in the
+	// block can be classified
+	for (; i + SIMD_WIDTH + 2 <= len; i += SIMD_WIDTH) {
+		const simd_vector v = simd_loadu(p + i);
+		const uint64_t lf   = simd_imask_from_mask(simd_cmpeq_i8_mask(v, simd_set_i8('\n')));
+		const uint64_t cont = simd_imask_from_mask(simd_cmpgt_i8_mask(simd_set_i8(-64), v));
+		const uint64_t high = simd_imask_from_mask(simd_cmpgt_i8_mask(simd_setzero(), v));
+		uint64_t ws = simd_imask_from_mask(simd_cmpws_i8_mask(v)) | spill;
+		bool bad = !synced;
+
+		spill = 0;
+		if (high != 0) {
+			const uint64_t e1 = simd_imask_from_mask(simd_cmpeq_i8_mask(v, simd_set_i8((char)0xE1)));
+			const uint64_t e2 = simd_imask_from_mask(simd_cmpeq_i8_mask(v, simd_set_i8((char)0xE2)));
+			const uint64_t e3 = simd_imask_from_mask(simd_cmpeq_i8_mask(v, simd_set_i8((char)0xE3)));
+			const uint64_t lead = e1 | e2 | e3;
+			if (lead != 0) {
+				// the second and third byte of every character starting here
+				const simd_vector v1 = simd_loadu(p + i + 1), v2 = simd_loadu(p + i + 2);
+				const uint64_t b80 = simd_imask_from_mask(simd_cmpeq_i8_mask(v1, simd_set_i8((char)0x80)));
+				const uint64_t b81 = simd_imask_from_mask(simd_cmpeq_i8_mask(v1, simd_set_i8((char)0x81)));
+				const uint64_t b9a = simd_imask_from_mask(simd_cmpeq_i8_mask(v1, simd_set_i8((char)0x9A)));
+				const uint64_t c80 = simd_imask_from_mask(simd_cmpeq_i8_mask(v2, simd_set_i8((char)0x80)));
+				const uint64_t c87 = simd_imask_from_mask(simd_cmpeq_i8_mask(v2, simd_set_i8((char)0x87)));
+				const uint64_t c9f = simd_imask_from_mask(simd_cmpeq_i8_mask(v2, simd_set_i8((char)0x9F)));
+				const uint64_t ca8 = simd_imask_from_mask(simd_cmpeq_i8_mask(v2, simd_set_i8((char)0xA8)));
+				const uint64_t ca9 = simd_imask_from_mask(simd_cmpeq_i8_mask(v2, simd_set_i8((char)0xA9)));
+				// 80..8A, as signed bytes -128..-118
+				const uint64_t c8x = simd_imask_from_mask(simd_cmpgt_i8_mask(simd_set_i8(-117), v2));
+				// U+1680, U+3000, U+2000..U+200A but U+2007, U+2028, U+2029, U+205F
+				const uint64_t sp = (e1 & b9a & c80) | (e3 & b80 & c80) |
+				                    (e2 & b80 & ((c8x & ~c87) | ca8 | ca9)) |
+				                    (e2 & b81 & c9f);
+				ws |= (sp | (sp << 1) | (sp << 2)) & all;
+				spill = ((sp >> (SIMD_WIDTH - 2)) & 1) | ((sp >> (SIMD_WIDTH - 1)) & 1) * 3;
+			}
+		}
+		if (!bad && (high | prev_high) != 0)
+			bad = !simd_testz(utf8_check_block(&tables, v, prev_block));
+		if (bad) {
+			size_t k = 0;
+			if (implied)
+				state = utf8_tail_state(s + i, &counts->invalid);
+			for (; k < SIMD_WIDTH - 4; ++k)
+				state = wc_utf8_step(state, s[i + k], &counts->invalid);
+			const uint64_t invalid = counts->invalid;
+			for (; k < SIMD_WIDTH; ++k)
+				state = wc_utf8_step(state, s[i + k], &counts->invalid);
+			synced = counts->invalid == invalid;
+			implied = false;
+		} else {
+			implied = true;
+		}
+		prev_block = v;
+		prev_high = high;
+		lines += (uint64_t)__builtin_popcountll(lf);
+		chars += SIMD_WIDTH - (uint64_t)__builtin_popcountll(cont);
+		words += (uint64_t)__builtin_popcountll(~ws & ~cont & ((ws << 1) | prev) & all);
+		prev = (ws >> (SIMD_WIDTH - 1)) & 1;
+	}
+	if (implied)
+		state = utf8_tail_state(s + i, &counts->invalid);
+	counts->lines += lines;
+	counts->words += words;
+	counts->chars += chars;
+	// the end of a space that ran past the last block
+	for (; spill; spill >>= 1, ++i)
+		state = wc_utf8_step(state, s[i], &counts->invalid);
+	counts->prev_ws = prev != 0;
+	counts->utf8_state = state;
+	wc_count_utf8_until(p + i, len - i, len - i, counts);
+}
+
+typedef struct {
+	simd_vector lo, hi, cmask[WC_CLASS_MAX];
+} classify_tables;
+
+static inline void classify_init(classify_tables *t, const wc_classes *cls)
+{
+	t->lo = simd_broadcast16(cls->lo);
+	t->hi = simd_broadcast16(cls->hi);
+	for (unsigned c = 0; c < cls->nclasses; ++c)
+		t->cmask[c] = simd_set_i8((char)cls->mask[c]);
+}
+
+static inline __attribute__((always_inline))
+void classify_block(const classify_tables *t, unsigned nclasses, const char *p, uint64_t *masks)
+{
+	const uint64_t all = SIMD_WIDTH == 64 ? ~(uint64_t)0 : ((uint64_t)1 << SIMD_WIDTH) - 1;
+	const simd_vector low4 = simd_set_i8(0x0f), zero = simd_setzero();
+	simd_vector tag[WC_CLASS_BLOCK / SIMD_WIDTH];
+
+	for (unsigned k = 0; k < WC_CLASS_BLOCK / SIMD_WIDTH; ++k) {
+		const simd_vector v = simd_loadu(p + k * SIMD_WIDTH);
+		tag[k] = simd_and(simd_shuffle_i8(t->lo, simd_and(v, low4)),
+		                  simd_shuffle_i8(t->hi, simd_and(simd_srli_i16(v, 4), low4)));
+	}
+	for (unsigned c = 0; c < nclasses; ++c) {
+		uint64_t out = 0;
+		for (unsigned k = 0; k < WC_CLASS_BLOCK / SIMD_WIDTH; ++k) {
+			const uint64_t none = simd_imask_from_mask(
+				simd_cmpeq_i8_mask(simd_and(tag[k], t->cmask[c]), zero));
+			out |= (~none & all) << (k * SIMD_WIDTH);
+		}
+		masks[c] = out;
+	}
+}
+
+#include "wc_classify_impl.h"
@@ -0,0 +1,4 @@
+#define WC_KERNEL      wc_count_sse42
+#define WC_KERNEL_UTF8 wc_count_utf8_sse42
+#define WC_CLASSIFY    wc_classify_sse42
+#include "wc_kernel_impl.h"